@@ -5,13 +5,49 @@
 #include <pthread.h>
 #include <stdint.h>
 
+/**
+ * @brief Memory layout of ApproximateCounter's per-thread slots.
+ */
+typedef enum
+{
+    kApproximateCounter_layoutDense = 0, // Packed arrays; neighbouring threads share cache lines
+    kApproximateCounter_layoutPadded     // One cache line per thread holding its count and lock
+} tApproximateCounter_layout;
+
+/**
+ * @brief How ApproximateCounter synchronizes access to the per-thread slots.
+ */
+typedef enum
+{
+    kApproximateCounter_syncLocked = 0, // Every slot access takes the slot's mutex
+    kApproximateCounter_syncOwner       // Lock-free; only the owning thread writes its slot
+} tApproximateCounter_sync;
+
 /**
  * @brief Options for ApproximateCounter.
+ *
+ * With kApproximateCounter_syncOwner, increment and flush for a given iThread
+ * must only be called by that thread (the background flusher excepted), and
+ * reset must not race with the callers' updates (it does wait out the background
+ * flusher).
+ *
+ * A non-zero mFlushPeriodMs starts a background thread that flushes every
+ * slot once per period, so a count is never more than one period stale on
+ * top of the mThreshold * mThreads error bound.
+ *
+ * A non-zero mMaxThreshold enables the adaptive threshold: each thread starts
+ * at mThreshold, doubles its threshold when a flush finds the global count
+ * contended and shrinks it by 1/8 when not, staying within
+ * [mThreshold, mMaxThreshold]. The error bound becomes mMaxThreshold * mThreads.
  */
 typedef struct
 {
-    uint32_t mThreshold; // Local counter threshold before flushing to global
-    uint32_t mThreads;   // Number of threads that will use this counter
+    uint32_t mThreshold;                // Local counter threshold before flushing to global
+    uint32_t mThreads;                  // Number of threads that will use this counter
+    tApproximateCounter_layout mLayout; // Per-thread slot layout
+    tApproximateCounter_sync mSync;     // Per-thread slot synchronization
+    uint32_t mFlushPeriodMs;            // Background flush period (0: no background flusher)
+    uint32_t mMaxThreshold;             // Adaptive threshold upper bound (0: fixed threshold)
 } tApproximateCounter_options;
 
 /**
@@ -0,0 +1,31 @@
+#ifndef ATOMIC_COUNTER_H
+#define ATOMIC_COUNTER_H
+
+#include <counter_api.h>
+#include <stdint.h>
+
+/**
+ * @brief Backoff strategy used by AtomicCounter when an update is contended.
+ */
+typedef enum
+{
+    kAtomicCounter_backoffNone = 0, // Single fetch_add, let the hardware arbitrate
+    kAtomicCounter_backoffSpin,     // CAS loop, exponential pause-spin on failure
+    kAtomicCounter_backoffYield     // CAS loop, sched_yield on failure
+} tAtomicCounter_backoff;
+
+/**
+ * @brief Options for AtomicCounter.
+ */
+typedef struct
+{
+    tAtomicCounter_backoff mBackoff; // Backoff strategy on contention
+    uint32_t mMaxSpins;              // Cap on the exponential spin (kAtomicCounter_backoffSpin)
+} tAtomicCounter_options;
+
+/**
+ * @brief Global AtomicCounter interface. Defined in AtomicCounter.c.
+ */
+extern const tCounter_interface gAtomicCounter_interface;
+
+#endif // ATOMIC_COUNTER_H
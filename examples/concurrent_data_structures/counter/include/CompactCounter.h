@@ -0,0 +1,81 @@
+#ifndef COMPACT_COUNTER_H
+#define COMPACT_COUNTER_H
+
+#include <counter_api.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Width of a CompactCounter local slot.
+ */
+typedef enum
+{
+    kCompactCounter_width8 = 1, // 1-byte slots, flushed by 255 at the latest
+    kCompactCounter_width16 = 2 // 2-byte slots, flushed by 65535 at the latest
+} tCompactCounter_width;
+
+/**
+ * @brief Per-thread local slots shared by many CompactCounters.
+ *
+ * Each thread owns one row of narrow slots, padded to whole cache lines and
+ * indexed by counter id, so a thread's slots for many counters sit together
+ * and no two threads write the same line. Counters take an id on create and
+ * give it back on destroy.
+ */
+typedef struct __tCompactCounter_slab tCompactCounter_slab;
+
+/**
+ * @brief Options for a CompactCounter slab.
+ */
+typedef struct
+{
+    uint32_t mThreads;            // Number of threads that will use its counters
+    uint32_t mCounters;           // Most counters that can live in the slab at once
+    tCompactCounter_width mWidth; // Bytes per local slot
+} tCompactCounter_slabOptions;
+
+/**
+ * @brief Options for CompactCounter.
+ */
+typedef struct
+{
+    uint32_t mThreshold;            // Local count at which a slot is flushed (clamped to the slot's range)
+    tCompactCounter_slab *mSlabPtr; // Slab holding the local slots (required)
+} tCompactCounter_options;
+
+/**
+ * @brief Allocate a slab of local slots reading zero.
+ *
+ * @param iOptionsPtr Pointer to tCompactCounter_slabOptions (required).
+ * @return Pointer to new slab.
+ */
+tCompactCounter_slab *CompactCounter_createSlab(const tCompactCounter_slabOptions *iOptionsPtr);
+
+/**
+ * @brief Free the slab. Every counter using it must be destroyed first.
+ *
+ * @param ioSlabPtr Slab to destroy.
+ */
+void CompactCounter_destroySlab(tCompactCounter_slab *ioSlabPtr);
+
+/**
+ * @brief Bytes of slot storage per counter the slab can hold (its padded
+ *        rows divided by its capacity).
+ *
+ * @param iSlabPtr Slab to measure.
+ * @return Slot bytes per counter.
+ */
+size_t CompactCounter_slotBytes(const tCompactCounter_slab *iSlabPtr);
+
+/**
+ * @brief Global CompactCounter interface. Defined in CompactCounter.c.
+ *
+ * Sloppy counter sized for millions of instances. An instance holds only
+ * its 32-bit global count and a slab id; its local counts are mThreads
+ * narrow slots in the slab, written by their owner without a lock and
+ * flushed to the global count before they could overflow. iThread must be
+ * below the slab's mThreads.
+ */
+extern const tCounter_interface gCompactCounter_interface;
+
+#endif // COMPACT_COUNTER_H
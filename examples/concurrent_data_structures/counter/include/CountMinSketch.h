@@ -0,0 +1,94 @@
+#ifndef COUNT_MIN_SKETCH_H
+#define COUNT_MIN_SKETCH_H
+
+#include <stdint.h>
+
+/**
+ * @brief How threads share the sketch's counters.
+ */
+typedef enum
+{
+    kCountMinSketch_modeSharded = 0, // One private table per thread, summed by queries
+    kCountMinSketch_modeAtomic       // One shared table updated with relaxed fetch_add
+} tCountMinSketch_mode;
+
+/**
+ * @brief Options for CountMinSketch.
+ */
+typedef struct
+{
+    uint32_t mThreads;          // Number of threads updating the sketch
+    uint32_t mDepth;            // Number of rows (hash functions), error probability ~ e^-depth
+    uint32_t mWidth;            // Counters per row, rounded up to a power of two; error ~ e / width
+    tCountMinSketch_mode mMode; // See tCountMinSketch_mode
+} tCountMinSketch_options;
+
+/**
+ * @brief Count-min sketch: per-key frequency estimates in fixed memory.
+ *
+ * An update adds to one counter in each of mDepth rows; a point query takes
+ * the minimum of those counters, which never underestimates. In sharded mode
+ * each thread owns a table, like SummingCounter's slots, and a query sums the
+ * shards before taking the minimum.
+ */
+typedef struct __tCountMinSketch tCountMinSketch;
+
+/**
+ * @brief Allocate an empty sketch.
+ *
+ * @param iOptionsPtr Pointer to tCountMinSketch_options (required).
+ * @return Pointer to new sketch.
+ */
+tCountMinSketch *CountMinSketch_create(const tCountMinSketch_options *iOptionsPtr);
+
+/**
+ * @brief Free the sketch.
+ *
+ * @param ioSketchPtr Sketch to destroy.
+ */
+void CountMinSketch_destroy(tCountMinSketch *ioSketchPtr);
+
+/**
+ * @brief Zero all counters. Writers must be quiescent.
+ *
+ * @param ioSketchPtr Sketch to reset.
+ */
+void CountMinSketch_reset(tCountMinSketch *ioSketchPtr);
+
+/**
+ * @brief No-op: tables are read in place, there is nothing to flush.
+ *
+ * @param ioSketchPtr Sketch instance.
+ * @param iThread Thread ID.
+ */
+void CountMinSketch_flush(tCountMinSketch *ioSketchPtr, const uint32_t iThread);
+
+/**
+ * @brief Count iAmount occurrences of a key.
+ *
+ * @param ioSketchPtr Sketch to update.
+ * @param iThread Thread ID (0 to mThreads-1).
+ * @param iKey Key to count.
+ * @param iAmount Occurrences to add.
+ */
+void CountMinSketch_add(tCountMinSketch *ioSketchPtr, const uint32_t iThread, const uint64_t iKey, const uint32_t iAmount);
+
+/**
+ * @brief Estimated occurrences of a key: at least the true count, and above
+ *        it by more than e / width of the total with probability e^-depth.
+ *
+ * @param ioSketchPtr Sketch to query.
+ * @param iKey Key to look up.
+ * @return Estimated count.
+ */
+uint64_t CountMinSketch_estimate(tCountMinSketch *ioSketchPtr, const uint64_t iKey);
+
+/**
+ * @brief Exact total of all amounts added (the sum of any one row).
+ *
+ * @param ioSketchPtr Sketch to read.
+ * @return Total count.
+ */
+uint64_t CountMinSketch_total(tCountMinSketch *ioSketchPtr);
+
+#endif // COUNT_MIN_SKETCH_H
@@ -0,0 +1,112 @@
+#ifndef COUNTER_MAP_H
+#define COUNTER_MAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Options for CounterMap.
+ */
+typedef struct
+{
+    uint32_t mThreads;    // Number of threads (delta caches) adding to counters
+    uint32_t mBuckets;    // Hash buckets, rounded up to a power of two (0: default 65536)
+    uint32_t mStripes;    // Insert locks, each guarding every mStripes-th bucket (0: default 64)
+    uint32_t mCacheSlots; // Hot keys cached per thread, rounded up to a power of two (0: default 64)
+    uint32_t mThreshold;  // Per-thread delta at which a key's count is flushed to its counter
+} tCounterMap_options;
+
+/**
+ * @brief Called for each key by CounterMap_forEach.
+ *
+ * @param iKeyPtr Key bytes.
+ * @param iKeyLength Key length in bytes.
+ * @param iCount Count of the key.
+ * @param ioContextPtr Caller context passed to CounterMap_forEach.
+ */
+typedef void(tCounterMap_visit)(const void *iKeyPtr, size_t iKeyLength, uint64_t iCount, void *ioContextPtr);
+
+/**
+ * @brief Concurrent table of named counters.
+ *
+ * Keys are byte strings (pass &value, sizeof value for integer keys). Each
+ * key costs one small heap entry holding the key and a 64-bit count, instead
+ * of a whole counter instance. Lookups walk the bucket chain without locks;
+ * inserts take one of mStripes stripe locks. Each thread keeps a small
+ * direct-mapped cache of hot keys and their pending deltas, flushed to the
+ * key's count at mThreshold like ApproximateCounter's mLocal, so repeated
+ * adds to a hot key touch only the caller's cache. Entries are never
+ * removed before reset, so the table does not resize: size mBuckets for the
+ * expected number of keys. A thread's cached deltas only reach get once
+ * they are flushed, so flush before a thread goes idle.
+ */
+typedef struct __tCounterMap tCounterMap;
+
+/**
+ * @brief Allocate an empty map.
+ *
+ * @param iOptionsPtr Pointer to tCounterMap_options (required).
+ * @return Pointer to new map.
+ */
+tCounterMap *CounterMap_create(const tCounterMap_options *iOptionsPtr);
+
+/**
+ * @brief Free the map and all its keys.
+ *
+ * @param ioMapPtr Map to destroy.
+ */
+void CounterMap_destroy(tCounterMap *ioMapPtr);
+
+/**
+ * @brief Remove all keys. Writers and readers must be quiescent.
+ *
+ * @param ioMapPtr Map to reset.
+ */
+void CounterMap_reset(tCounterMap *ioMapPtr);
+
+/**
+ * @brief Flush a thread's cached deltas to their counts. Called by the
+ *        owning thread.
+ *
+ * @param ioMapPtr Map instance.
+ * @param iThread Thread ID to flush.
+ */
+void CounterMap_flush(tCounterMap *ioMapPtr, const uint32_t iThread);
+
+/**
+ * @brief Add to a key's count, inserting the key on first use.
+ *
+ * @param ioMapPtr Map to update.
+ * @param iThread Thread ID (0 to mThreads-1).
+ * @param iKeyPtr Key bytes (copied on insert).
+ * @param iKeyLength Key length in bytes.
+ * @param iAmount Amount to add.
+ */
+void CounterMap_add(tCounterMap *ioMapPtr,
+                    const uint32_t iThread,
+                    const void *iKeyPtr,
+                    const size_t iKeyLength,
+                    const uint32_t iAmount);
+
+/**
+ * @brief Flushed count of a key (cached deltas are not included).
+ *
+ * @param ioMapPtr Map to read.
+ * @param iKeyPtr Key bytes.
+ * @param iKeyLength Key length in bytes.
+ * @return Count of the key, 0 if it was never added.
+ */
+uint64_t CounterMap_get(tCounterMap *ioMapPtr, const void *iKeyPtr, const size_t iKeyLength);
+
+/**
+ * @brief Visit every key and its flushed count, e.g. for export. Runs
+ *        without locks alongside writers; keys inserted meanwhile may or may
+ *        not be visited.
+ *
+ * @param ioMapPtr Map to read.
+ * @param iVisitPtr Called once per key.
+ * @param ioContextPtr Passed to iVisitPtr.
+ */
+void CounterMap_forEach(tCounterMap *ioMapPtr, tCounterMap_visit *iVisitPtr, void *ioContextPtr);
+
+#endif // COUNTER_MAP_H
@@ -0,0 +1,87 @@
+#ifndef COUNTER_VECTOR_H
+#define COUNTER_VECTOR_H
+
+#include <stdint.h>
+
+/**
+ * @brief Options for CounterVector.
+ */
+typedef struct
+{
+    uint32_t mThreads;  // Number of threads (rows) updating the counters
+    uint32_t mCounters; // Number of related counters (columns), e.g. one per status code
+} tCounterVector_options;
+
+/**
+ * @brief A family of mCounters related counters in one block.
+ *
+ * Each thread owns one contiguous, cache-aligned row holding its local count
+ * of every counter; only the owner writes it, as with SummingCounter's slots.
+ * Eight uint64_t counts fit a cache line, so counters whose indices fall in
+ * the same group of eight (0-7, 8-15, ...) share a line of the caller's row;
+ * give counters that are bumped together neighbouring indices. The whole
+ * family is one allocation. Reads sum a column across the rows.
+ */
+typedef struct __tCounterVector tCounterVector;
+
+/**
+ * @brief Allocate a vector of counters reading zero.
+ *
+ * @param iOptionsPtr Pointer to tCounterVector_options (required).
+ * @return Pointer to new counter vector.
+ */
+tCounterVector *CounterVector_create(const tCounterVector_options *iOptionsPtr);
+
+/**
+ * @brief Free the counter vector.
+ *
+ * @param ioVectorPtr Counter vector to destroy.
+ */
+void CounterVector_destroy(tCounterVector *ioVectorPtr);
+
+/**
+ * @brief Reset all counters to zero. Writers must be quiescent.
+ *
+ * @param ioVectorPtr Counter vector to reset.
+ */
+void CounterVector_reset(tCounterVector *ioVectorPtr);
+
+/**
+ * @brief No-op: rows are read in place, there is nothing to flush.
+ *
+ * @param ioVectorPtr Counter vector instance.
+ * @param iThread Thread ID.
+ */
+void CounterVector_flush(tCounterVector *ioVectorPtr, const uint32_t iThread);
+
+/**
+ * @brief Add to one counter of the family.
+ *
+ * @param ioVectorPtr Counter vector to update.
+ * @param iThread Thread ID (0 to mThreads-1).
+ * @param iCounter Counter index (0 to mCounters-1).
+ * @param iAmount Amount to add.
+ */
+void CounterVector_add(tCounterVector *ioVectorPtr,
+                       const uint32_t iThread,
+                       const uint32_t iCounter,
+                       const uint32_t iAmount);
+
+/**
+ * @brief Read one counter (its column sum).
+ *
+ * @param ioVectorPtr Counter vector to read.
+ * @param iCounter Counter index (0 to mCounters-1).
+ * @param oCount Pointer to write the count to.
+ */
+void CounterVector_get(tCounterVector *ioVectorPtr, const uint32_t iCounter, uint64_t *oCount);
+
+/**
+ * @brief Read every counter in one pass over the rows.
+ *
+ * @param ioVectorPtr Counter vector to read.
+ * @param oCounts Array of mCounters entries to write the counts to.
+ */
+void CounterVector_getAll(tCounterVector *ioVectorPtr, uint64_t *oCounts);
+
+#endif // COUNTER_VECTOR_H
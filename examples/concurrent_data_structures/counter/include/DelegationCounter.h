@@ -0,0 +1,27 @@
+#ifndef DELEGATION_COUNTER_H
+#define DELEGATION_COUNTER_H
+
+#include <counter_api.h>
+#include <stdint.h>
+
+/**
+ * @brief Options for DelegationCounter.
+ */
+typedef struct
+{
+    uint32_t mThreads; // Number of client threads that will use this counter
+} tDelegationCounter_options;
+
+/**
+ * @brief Global DelegationCounter interface. Defined in DelegationCounter.c.
+ *
+ * mCreatePtr starts a server thread that is the only writer of the count and
+ * mDestroyPtr joins it. Clients post increments to their own mailbox and
+ * return immediately; flush waits until the server has applied the caller's
+ * posts. Increment and flush for a given iThread must only be called by that
+ * thread. An idle server backs off to sleeping for up to about 1 ms, so the
+ * first flush or reset after a quiet spell may wait that long.
+ */
+extern const tCounter_interface gDelegationCounter_interface;
+
+#endif // DELEGATION_COUNTER_H
@@ -0,0 +1,29 @@
+#ifndef DYNAMIC_COUNTER_H
+#define DYNAMIC_COUNTER_H
+
+#include <counter_api.h>
+#include <stdint.h>
+
+/**
+ * @brief Options for DynamicCounter.
+ */
+typedef struct
+{
+    uint32_t mThreshold; // Local counter threshold before flushing to global
+} tDynamicCounter_options;
+
+/**
+ * @brief Global DynamicCounter interface. Defined in DynamicCounter.c.
+ *
+ * Sloppy counter for a changing set of threads. A thread is given a slot the
+ * first time it touches the counter; iThread is ignored and flush drains the
+ * calling thread's slot. When a thread exits, its slot is flushed and
+ * recycled automatically. The slot table grows without moving existing slots,
+ * so it never blocks readers or writers.
+ *
+ * Each instance uses one pthread key, so at most PTHREAD_KEYS_MAX instances
+ * can exist at a time.
+ */
+extern const tCounter_interface gDynamicCounter_interface;
+
+#endif // DYNAMIC_COUNTER_H
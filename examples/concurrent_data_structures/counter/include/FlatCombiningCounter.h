@@ -0,0 +1,23 @@
+#ifndef FLAT_COMBINING_COUNTER_H
+#define FLAT_COMBINING_COUNTER_H
+
+#include <counter_api.h>
+#include <stdint.h>
+
+/**
+ * @brief Options for FlatCombiningCounter.
+ */
+typedef struct
+{
+    uint32_t mThreads; // Number of threads that will use this counter
+} tFlatCombiningCounter_options;
+
+/**
+ * @brief Global FlatCombiningCounter interface. Defined in FlatCombiningCounter.c.
+ *
+ * Exact counter: increment returns once its amount has been applied to the
+ * count, by the caller or by whichever thread held the combiner lock.
+ */
+extern const tCounter_interface gFlatCombiningCounter_interface;
+
+#endif // FLAT_COMBINING_COUNTER_H
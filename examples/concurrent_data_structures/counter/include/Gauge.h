@@ -0,0 +1,92 @@
+#ifndef GAUGE_H
+#define GAUGE_H
+
+#include <stdint.h>
+
+/**
+ * @brief Options for Gauge.
+ */
+typedef struct
+{
+    uint32_t mThreads;   // Number of threads (slots) updating the gauge
+    uint32_t mThreshold; // Local magnitude at which a slot is flushed to global
+} tGauge_options;
+
+/**
+ * @brief Signed gauge (e.g. requests in flight) with the scalability of
+ *        ApproximateCounter.
+ *
+ * Each thread accumulates signed deltas in its own padded slot and moves them
+ * to the global value once their magnitude reaches mThreshold. Thread IDs
+ * must be unique, as with ApproximateCounter.
+ */
+typedef struct __tGauge tGauge;
+
+/**
+ * @brief Allocate a gauge reading zero.
+ *
+ * @param iOptionsPtr Pointer to tGauge_options (required).
+ * @return Pointer to new gauge.
+ */
+tGauge *Gauge_create(const tGauge_options *iOptionsPtr);
+
+/**
+ * @brief Free the gauge.
+ *
+ * @param ioGaugePtr Gauge to destroy.
+ */
+void Gauge_destroy(tGauge *ioGaugePtr);
+
+/**
+ * @brief Reset the gauge to zero. Writers must be quiescent.
+ *
+ * @param ioGaugePtr Gauge to reset.
+ */
+void Gauge_reset(tGauge *ioGaugePtr);
+
+/**
+ * @brief Move a thread's local delta to the global value. Called by the
+ *        owning thread.
+ *
+ * @param ioGaugePtr Gauge instance.
+ * @param iThread Thread ID to flush.
+ */
+void Gauge_flush(tGauge *ioGaugePtr, const uint32_t iThread);
+
+/**
+ * @brief Add a signed delta to the gauge.
+ *
+ * @param ioGaugePtr Gauge to update.
+ * @param iThread Thread ID (0 to mThreads-1).
+ * @param iDelta Amount to add (negative to subtract).
+ */
+void Gauge_add(tGauge *ioGaugePtr, const uint32_t iThread, const int32_t iDelta);
+
+/**
+ * @brief Bounded read: the global value only. It differs from the true value
+ *        by at most Gauge_errorBound.
+ *
+ * @param ioGaugePtr Gauge to read from.
+ * @param oValue Pointer to write the value to.
+ */
+void Gauge_get(tGauge *ioGaugePtr, int64_t *oValue);
+
+/**
+ * @brief Exact read: every slot plus the global value. Exact when writers
+ *        are quiescent; a concurrent flush is never missed but may be counted
+ *        twice for a moment.
+ *
+ * @param ioGaugePtr Gauge to read from.
+ * @param oValue Pointer to write the value to.
+ */
+void Gauge_getExact(tGauge *ioGaugePtr, int64_t *oValue);
+
+/**
+ * @brief Largest error of Gauge_get, mThreads * (mThreshold - 1).
+ *
+ * @param iGaugePtr Gauge instance.
+ * @return Error bound.
+ */
+int64_t Gauge_errorBound(const tGauge *iGaugePtr);
+
+#endif // GAUGE_H
@@ -0,0 +1,37 @@
+#ifndef HIERARCHICAL_COUNTER_H
+#define HIERARCHICAL_COUNTER_H
+
+#include <counter_api.h>
+#include <stdint.h>
+
+/**
+ * @brief Which CPUs share an intermediate node of HierarchicalCounter.
+ */
+typedef enum
+{
+    kHierarchicalCounter_groupLlc = 0, // CPUs sharing a last-level cache
+    kHierarchicalCounter_groupPackage  // CPUs in the same physical package (socket)
+} tHierarchicalCounter_group;
+
+/**
+ * @brief Options for HierarchicalCounter.
+ */
+typedef struct
+{
+    uint32_t mThreshold;               // Local counter threshold before flushing to the node
+    uint32_t mNodeThreshold;           // Node counter threshold before flushing to the root
+    uint32_t mThreads;                 // Number of threads that will use this counter
+    tHierarchicalCounter_group mGroup; // CPU grouping of the intermediate nodes
+} tHierarchicalCounter_options;
+
+/**
+ * @brief Global HierarchicalCounter interface. Defined in HierarchicalCounter.c.
+ *
+ * Threads flush into the node of the CPU group they run on, and only nodes
+ * flush into the root, so most flush traffic stays inside one cache domain.
+ * Increment and flush for a given iThread must only be called by that thread,
+ * and reset must not race with updates.
+ */
+extern const tCounter_interface gHierarchicalCounter_interface;
+
+#endif // HIERARCHICAL_COUNTER_H
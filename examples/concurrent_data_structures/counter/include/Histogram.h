@@ -0,0 +1,104 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+
+/**
+ * @brief Options for Histogram.
+ */
+typedef struct
+{
+    uint32_t mThreads;       // Number of threads (rows) recording values
+    uint32_t mSubBucketBits; // Linear sub-buckets per power of two = 2^bits (0: default 5, ~3% resolution)
+} tHistogram_options;
+
+/**
+ * @brief Merged bucket counts of a histogram. Snapshots with the same
+ *        mSubBucketBits can be merged and queried without the histogram.
+ */
+typedef struct
+{
+    uint32_t mSubBucketBits; // Bucket layout (see tHistogram_options)
+    uint32_t mBucketCount;   // Number of entries in mCountsPtr
+    uint64_t mTotal;         // Sum of all bucket counts
+    uint64_t *mCountsPtr;    // Count per bucket
+} tHistogram_snapshot;
+
+/**
+ * @brief Log-linear (HDR-style) histogram of uint64_t values, e.g. latencies
+ *        in nanoseconds.
+ *
+ * Each power of two is split into 2^mSubBucketBits linear buckets, so every
+ * value is kept within a relative error of 2^-mSubBucketBits. Like
+ * SummingCounter, each thread counts into its own row of buckets and readers
+ * merge the rows on demand; recording never takes a lock or writes a line
+ * another thread writes.
+ */
+typedef struct __tHistogram tHistogram;
+
+/**
+ * @brief Allocate an empty histogram.
+ *
+ * @param iOptionsPtr Pointer to tHistogram_options (required).
+ * @return Pointer to new histogram.
+ */
+tHistogram *Histogram_create(const tHistogram_options *iOptionsPtr);
+
+/**
+ * @brief Free the histogram.
+ *
+ * @param ioHistogramPtr Histogram to destroy.
+ */
+void Histogram_destroy(tHistogram *ioHistogramPtr);
+
+/**
+ * @brief Record one value.
+ *
+ * @param ioHistogramPtr Histogram to update.
+ * @param iThread Thread ID (0 to mThreads-1).
+ * @param iValue Value to record.
+ */
+void Histogram_record(tHistogram *ioHistogramPtr, const uint32_t iThread, const uint64_t iValue);
+
+/**
+ * @brief Forget everything recorded so far. Writers may keep recording; a
+ *        value recorded concurrently lands on either side of the reset.
+ *
+ * @param ioHistogramPtr Histogram to reset.
+ */
+void Histogram_reset(tHistogram *ioHistogramPtr);
+
+/**
+ * @brief Merge all rows recorded since the last reset into a snapshot.
+ *
+ * @param ioHistogramPtr Histogram to read.
+ * @param oSnapshotPtr Snapshot to fill; allocated here, free with
+ *                     Histogram_snapshotFree.
+ */
+void Histogram_snapshot(tHistogram *ioHistogramPtr, tHistogram_snapshot *oSnapshotPtr);
+
+/**
+ * @brief Add the counts of one snapshot into another.
+ *
+ * @param ioIntoPtr Snapshot to add into.
+ * @param iFromPtr Snapshot to add; must have the same mSubBucketBits.
+ */
+void Histogram_snapshotMerge(tHistogram_snapshot *ioIntoPtr, const tHistogram_snapshot *iFromPtr);
+
+/**
+ * @brief Value at a percentile, reported as the highest value of its bucket.
+ *
+ * @param iSnapshotPtr Snapshot to query.
+ * @param iPercentile Percentile in [0, 100].
+ * @return Value at the percentile, 0 for an empty snapshot.
+ */
+uint64_t Histogram_snapshotPercentile(const tHistogram_snapshot *iSnapshotPtr, double iPercentile);
+
+/**
+ * @brief Free the counts of a snapshot.
+ *
+ * @param ioSnapshotPtr Snapshot to free.
+ */
+void Histogram_snapshotFree(tHistogram_snapshot *ioSnapshotPtr);
+
+#endif // HISTOGRAM_H
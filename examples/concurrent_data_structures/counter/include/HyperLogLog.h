@@ -0,0 +1,73 @@
+#ifndef HYPER_LOG_LOG_H
+#define HYPER_LOG_LOG_H
+
+#include <stdint.h>
+
+/**
+ * @brief Options for HyperLogLog.
+ */
+typedef struct
+{
+    uint32_t mThreads;   // Number of threads (register rows) adding items
+    uint32_t mPrecision; // log2 of the register count, 6 to 18 (0: default 14, ~0.8% error)
+} tHyperLogLog_options;
+
+/**
+ * @brief Distinct-count sketch (HyperLogLog).
+ *
+ * Each thread keeps a private row of 2^mPrecision one-byte registers. An add
+ * hashes the item and raises one register of the caller's row, which only
+ * happens a few times per register, so most adds are a hash and a load. Reads
+ * merge the rows with an element-wise (SIMD) max and estimate from the merged
+ * registers.
+ */
+typedef struct __tHyperLogLog tHyperLogLog;
+
+/**
+ * @brief Allocate an empty sketch.
+ *
+ * @param iOptionsPtr Pointer to tHyperLogLog_options (required).
+ * @return Pointer to new sketch.
+ */
+tHyperLogLog *HyperLogLog_create(const tHyperLogLog_options *iOptionsPtr);
+
+/**
+ * @brief Free the sketch.
+ *
+ * @param ioSketchPtr Sketch to destroy.
+ */
+void HyperLogLog_destroy(tHyperLogLog *ioSketchPtr);
+
+/**
+ * @brief Forget all items. Writers must be quiescent.
+ *
+ * @param ioSketchPtr Sketch to reset.
+ */
+void HyperLogLog_reset(tHyperLogLog *ioSketchPtr);
+
+/**
+ * @brief No-op: rows are read in place, there is nothing to flush.
+ *
+ * @param ioSketchPtr Sketch instance.
+ * @param iThread Thread ID.
+ */
+void HyperLogLog_flush(tHyperLogLog *ioSketchPtr, const uint32_t iThread);
+
+/**
+ * @brief Add an item (e.g. a user ID). Adding an item again has no effect.
+ *
+ * @param ioSketchPtr Sketch to update.
+ * @param iThread Thread ID (0 to mThreads-1).
+ * @param iItem Item to add.
+ */
+void HyperLogLog_add(tHyperLogLog *ioSketchPtr, const uint32_t iThread, const uint64_t iItem);
+
+/**
+ * @brief Estimate the number of distinct items added since the last reset.
+ *
+ * @param ioSketchPtr Sketch to read from.
+ * @param oEstimate Pointer to write the estimate to.
+ */
+void HyperLogLog_get(tHyperLogLog *ioSketchPtr, uint64_t *oEstimate);
+
+#endif // HYPER_LOG_LOG_H
@@ -0,0 +1,23 @@
+#ifndef PER_CPU_COUNTER_H
+#define PER_CPU_COUNTER_H
+
+#include <counter_api.h>
+#include <stdint.h>
+
+/**
+ * @brief Options for PerCpuCounter.
+ */
+typedef struct
+{
+    uint32_t mShards; // Number of shards (0: one per configured CPU)
+} tPerCpuCounter_options;
+
+/**
+ * @brief Global PerCpuCounter interface. Defined in PerCpuCounter.c.
+ *
+ * Increments go to the shard of the CPU the caller is running on, so iThread
+ * is ignored and any number of threads may use the counter.
+ */
+extern const tCounter_interface gPerCpuCounter_interface;
+
+#endif // PER_CPU_COUNTER_H
@@ -0,0 +1,34 @@
+#ifndef PROBABILISTIC_COUNTER_H
+#define PROBABILISTIC_COUNTER_H
+
+#include <counter_api.h>
+#include <stdint.h>
+
+/**
+ * @brief Options for ProbabilisticCounter.
+ */
+typedef struct
+{
+    double mBase;          // Growth base a > 1 of the logarithmic state (<= 1: derive from mRelativeError)
+    double mRelativeError; // Target relative standard error, used when mBase <= 1
+} tProbabilisticCounter_options;
+
+/**
+ * @brief Global ProbabilisticCounter interface. Defined in ProbabilisticCounter.c.
+ *
+ * Morris-style counter: the state is a level c and the count estimate is
+ * (a^c - 1) / (a - 1). An increment raises c with probability a^-c, so most
+ * increments only draw a thread-local random number. iThread is ignored.
+ */
+extern const tCounter_interface gProbabilisticCounter_interface;
+
+/**
+ * @brief Expected relative standard error of a probabilistic counter's get,
+ *        sqrt((a - 1) / 2).
+ *
+ * @param iInstancePtr Counter created by gProbabilisticCounter_interface.
+ * @return Relative standard error of the estimate.
+ */
+double ProbabilisticCounter_relativeError(const tCounter_instance *iInstancePtr);
+
+#endif // PROBABILISTIC_COUNTER_H
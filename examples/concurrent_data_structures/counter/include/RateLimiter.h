@@ -0,0 +1,82 @@
+#ifndef RATE_LIMITER_H
+#define RATE_LIMITER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Options for RateLimiter.
+ */
+typedef struct
+{
+    uint32_t mThreads;    // Number of threads (local buckets) acquiring tokens
+    uint32_t mRatePerSec; // Tokens added to the global bucket per second
+    uint32_t mBurst;      // Capacity of the global bucket
+    uint32_t mChunk;      // Tokens leased to a local bucket at a time (1: no leasing)
+} tRateLimiter_options;
+
+/**
+ * @brief Token-bucket rate limiter with per-thread token leasing.
+ *
+ * The global bucket refills continuously from CLOCK_MONOTONIC and is kept as
+ * one atomic "theoretical arrival time" (GCRA), so a lease is one clock read
+ * and one compare-and-swap. A thread leases up to mChunk tokens at a time and
+ * spends them from its own cache line; like ApproximateCounter's threshold,
+ * the global state is touched once per chunk. Over any window, admissions
+ * exceed rate * window + mBurst by at most RateLimiter_overshootBound, the
+ * tokens that can sit in local buckets; flush a thread before it goes idle
+ * to give its tokens back.
+ */
+typedef struct __tRateLimiter tRateLimiter;
+
+/**
+ * @brief Allocate a limiter with a full global bucket.
+ *
+ * @param iOptionsPtr Pointer to tRateLimiter_options (required).
+ * @return Pointer to new limiter.
+ */
+tRateLimiter *RateLimiter_create(const tRateLimiter_options *iOptionsPtr);
+
+/**
+ * @brief Free the limiter.
+ *
+ * @param ioLimiterPtr Limiter to destroy.
+ */
+void RateLimiter_destroy(tRateLimiter *ioLimiterPtr);
+
+/**
+ * @brief Refill the global bucket and drop all leases. Callers must be
+ *        quiescent.
+ *
+ * @param ioLimiterPtr Limiter to reset.
+ */
+void RateLimiter_reset(tRateLimiter *ioLimiterPtr);
+
+/**
+ * @brief Return a thread's unspent leased tokens to the global bucket.
+ *        Called by the owning thread, e.g. before it goes idle.
+ *
+ * @param ioLimiterPtr Limiter instance.
+ * @param iThread Thread ID to flush.
+ */
+void RateLimiter_flush(tRateLimiter *ioLimiterPtr, const uint32_t iThread);
+
+/**
+ * @brief Take one token if one is available.
+ *
+ * @param ioLimiterPtr Limiter to draw from.
+ * @param iThread Thread ID (0 to mThreads-1).
+ * @return true if the request is admitted.
+ */
+bool RateLimiter_tryAcquire(tRateLimiter *ioLimiterPtr, const uint32_t iThread);
+
+/**
+ * @brief Most tokens that can be admitted beyond the configured rate and
+ *        burst, mThreads * (mChunk - 1).
+ *
+ * @param iLimiterPtr Limiter instance.
+ * @return Overshoot bound in tokens.
+ */
+uint64_t RateLimiter_overshootBound(const tRateLimiter *iLimiterPtr);
+
+#endif // RATE_LIMITER_H
@@ -0,0 +1,103 @@
+#ifndef REF_COUNTER_H
+#define REF_COUNTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Called once when a killed reference count drops to zero.
+ *
+ * @param ioContextPtr mContextPtr from tRefCounter_options.
+ */
+typedef void(tRefCounter_release)(void *ioContextPtr);
+
+/**
+ * @brief Options for RefCounter.
+ */
+typedef struct
+{
+    uint32_t mThreads;                // Number of threads (slots) taking and dropping references
+    tRefCounter_release *mReleasePtr; // Called when the count drops to zero after kill (may be NULL)
+    void *mContextPtr;                // Passed to mReleasePtr
+} tRefCounter_options;
+
+/**
+ * @brief Scalable reference count in the style of the kernel's percpu_ref.
+ *
+ * While the object is live, get and put only touch the calling thread's slot
+ * (one cache line per thread, as in ApproximateCounter's padded layout), so
+ * hot lookups never write a shared line. The count can not reach zero in this
+ * mode. RefCounter_kill flushes every slot into one atomic count and drops the
+ * initial reference; from then on get and put go to that atomic and the drop
+ * to zero is detected exactly.
+ */
+typedef struct __tRefCounter tRefCounter;
+
+/**
+ * @brief Allocate a live reference count holding one (initial) reference.
+ *
+ * @param iOptionsPtr Pointer to tRefCounter_options (required).
+ * @return Pointer to new reference count.
+ */
+tRefCounter *RefCounter_create(const tRefCounter_options *iOptionsPtr);
+
+/**
+ * @brief Free the reference count. No thread may use it afterwards.
+ *
+ * @param ioRefPtr Reference count to destroy.
+ */
+void RefCounter_destroy(tRefCounter *ioRefPtr);
+
+/**
+ * @brief Take a reference. The caller must already hold one.
+ *
+ * @param ioRefPtr Reference count.
+ * @param iThread Thread ID (0 to mThreads-1).
+ */
+void RefCounter_get(tRefCounter *ioRefPtr, const uint32_t iThread);
+
+/**
+ * @brief Take a reference unless the count has dropped to zero.
+ *
+ * @param ioRefPtr Reference count.
+ * @param iThread Thread ID (0 to mThreads-1).
+ * @return true if a reference was taken.
+ */
+bool RefCounter_tryGet(tRefCounter *ioRefPtr, const uint32_t iThread);
+
+/**
+ * @brief Take a reference unless the count has been killed.
+ *
+ * @param ioRefPtr Reference count.
+ * @param iThread Thread ID (0 to mThreads-1).
+ * @return true if a reference was taken.
+ */
+bool RefCounter_tryGetLive(tRefCounter *ioRefPtr, const uint32_t iThread);
+
+/**
+ * @brief Drop a reference. Calls the release callback if this was the last
+ *        reference of a killed count.
+ *
+ * @param ioRefPtr Reference count.
+ * @param iThread Thread ID (0 to mThreads-1).
+ */
+void RefCounter_put(tRefCounter *ioRefPtr, const uint32_t iThread);
+
+/**
+ * @brief Switch to a single atomic count and drop the initial reference.
+ *        Must be called exactly once; may run concurrently with get and put.
+ *
+ * @param ioRefPtr Reference count.
+ */
+void RefCounter_kill(tRefCounter *ioRefPtr);
+
+/**
+ * @brief Current number of references. Exact once killed; a racy snapshot of
+ *        the slots while live.
+ *
+ * @param ioRefPtr Reference count.
+ * @return Number of references.
+ */
+uint64_t RefCounter_count(tRefCounter *ioRefPtr);
+
+#endif // REF_COUNTER_H
@@ -0,0 +1,77 @@
+#ifndef SEQUENCE_ALLOCATOR_H
+#define SEQUENCE_ALLOCATOR_H
+
+#include <stdint.h>
+
+/**
+ * @brief Ordering of the values handed out by a SequenceAllocator.
+ */
+typedef enum
+{
+    kSequenceAllocator_orderPerThread = 0, // Lease blocks; values rise per thread only
+    kSequenceAllocator_orderGlobal         // One shared fetch_add per value; values rise globally
+} tSequenceAllocator_order;
+
+/**
+ * @brief Options for SequenceAllocator.
+ */
+typedef struct
+{
+    uint32_t mThreads;               // Number of threads (slots) drawing values
+    uint32_t mBlockSize;             // Values leased per shared operation (orderPerThread)
+    tSequenceAllocator_order mOrder; // See tSequenceAllocator_order
+} tSequenceAllocator_options;
+
+/**
+ * @brief Unique ID / sequence number generator.
+ *
+ * Each thread leases mBlockSize consecutive values from the global sequence
+ * with a single fetch_add and hands them out from its own cache line, the
+ * threshold idea of ApproximateCounter applied to unique values. Every value
+ * is handed out at most once. Values leased but not yet handed out when a
+ * thread stops are skipped, so the sequence can have gaps.
+ */
+typedef struct __tSequenceAllocator tSequenceAllocator;
+
+/**
+ * @brief Allocate a sequence allocator starting at zero.
+ *
+ * @param iOptionsPtr Pointer to tSequenceAllocator_options (required).
+ * @return Pointer to new allocator.
+ */
+tSequenceAllocator *SequenceAllocator_create(const tSequenceAllocator_options *iOptionsPtr);
+
+/**
+ * @brief Free the allocator.
+ *
+ * @param ioAllocatorPtr Allocator to destroy.
+ */
+void SequenceAllocator_destroy(tSequenceAllocator *ioAllocatorPtr);
+
+/**
+ * @brief Restart the sequence at zero and drop all leases. Callers must be
+ *        quiescent.
+ *
+ * @param ioAllocatorPtr Allocator to reset.
+ */
+void SequenceAllocator_reset(tSequenceAllocator *ioAllocatorPtr);
+
+/**
+ * @brief Hand out the next unique value.
+ *
+ * @param ioAllocatorPtr Allocator to draw from.
+ * @param iThread Thread ID (0 to mThreads-1).
+ * @return A value no other call has returned since the last reset.
+ */
+uint64_t SequenceAllocator_next(tSequenceAllocator *ioAllocatorPtr, const uint32_t iThread);
+
+/**
+ * @brief Number of values taken from the global sequence so far (handed out
+ *        or leased).
+ *
+ * @param ioAllocatorPtr Allocator to read.
+ * @return Global high-water mark.
+ */
+uint64_t SequenceAllocator_leased(tSequenceAllocator *ioAllocatorPtr);
+
+#endif // SEQUENCE_ALLOCATOR_H
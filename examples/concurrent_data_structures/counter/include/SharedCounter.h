@@ -0,0 +1,114 @@
+#ifndef SHARED_COUNTER_H
+#define SHARED_COUNTER_H
+
+#include <stdint.h>
+
+/**
+ * @brief How SharedCounter updates are synchronized across processes.
+ */
+typedef enum
+{
+    kSharedCounter_modeSharded = 0, // One cache-aligned row per worker, summed by reads
+    kSharedCounter_modeAtomic,      // One shared row updated with relaxed fetch_add
+    kSharedCounter_modeLocked       // One shared row guarded by a process-shared mutex
+} tSharedCounter_mode;
+
+/**
+ * @brief Options for SharedCounter.
+ */
+typedef struct
+{
+    const char *mNamePtr;      // shm_open name ("/name"), or NULL for an anonymous mapping
+    uint32_t mWorkers;         // Number of workers (processes or threads) updating the counters
+    uint32_t mCounters;        // Number of counters in the segment
+    tSharedCounter_mode mMode; // Update synchronization
+} tSharedCounter_options;
+
+/**
+ * @brief A family of counters living in shared memory, for prefork servers.
+ *
+ * All state is in one MAP_SHARED segment: a header followed by the count
+ * rows. An anonymous segment must be created before fork() and is inherited
+ * by the children; a named segment (shm_open) can also be attached by
+ * unrelated processes with SharedCounter_open. Nothing in the segment is a
+ * pointer, so it may be mapped at different addresses.
+ *
+ * This is a separate type rather than a backing store for the
+ * tCounter_interface counters. Those counters point into the process-private
+ * heap and use process-private mutexes, and some of them run helper threads.
+ * None of that works across processes. The sharded mode uses the
+ * CounterVector row layout.
+ *
+ * Workers are numbered 0 to mWorkers-1 and each must have a unique ID, as
+ * threads do elsewhere in this library. The locked mode uses a robust
+ * mutex, so a worker that dies inside an update does not wedge the others.
+ * Every process but the creator closes its handle when done; the creator
+ * destroys the segment once the workers have stopped.
+ */
+typedef struct __tSharedCounter tSharedCounter;
+
+/**
+ * @brief Create a shared segment of counters reading zero.
+ *
+ * @param iOptionsPtr Pointer to tSharedCounter_options (required).
+ * @return Pointer to a handle on the new segment, or NULL if the named
+ *         segment already exists or could not be created.
+ */
+tSharedCounter *SharedCounter_create(const tSharedCounter_options *iOptionsPtr);
+
+/**
+ * @brief Attach to a named segment created by another process.
+ *
+ * @param iNamePtr shm_open name passed to SharedCounter_create.
+ * @return Pointer to a handle on the segment, or NULL if it does not exist
+ *         or is not initialized yet.
+ */
+tSharedCounter *SharedCounter_open(const char *iNamePtr);
+
+/**
+ * @brief Unmap the segment from this process and free the handle. The
+ *        counters are left intact for the other processes.
+ *
+ * @param ioCounterPtr Handle to close.
+ */
+void SharedCounter_close(tSharedCounter *ioCounterPtr);
+
+/**
+ * @brief Tear down the segment: destroy its mutex, unlink its name and close
+ *        the handle. Call from the creating process once every worker has
+ *        stopped.
+ *
+ * @param ioCounterPtr Handle returned by SharedCounter_create.
+ */
+void SharedCounter_destroy(tSharedCounter *ioCounterPtr);
+
+/**
+ * @brief Reset all counters to zero. Writers must be quiescent.
+ *
+ * @param ioCounterPtr Counters to reset.
+ */
+void SharedCounter_reset(tSharedCounter *ioCounterPtr);
+
+/**
+ * @brief Add to one counter.
+ *
+ * @param ioCounterPtr Counters to update.
+ * @param iWorker Worker ID (0 to mWorkers-1) of the caller.
+ * @param iCounter Counter index (0 to mCounters-1).
+ * @param iAmount Amount to add.
+ */
+void SharedCounter_add(tSharedCounter *ioCounterPtr,
+                       const uint32_t iWorker,
+                       const uint32_t iCounter,
+                       const uint32_t iAmount);
+
+/**
+ * @brief Read one counter.
+ *
+ * @param ioCounterPtr Counters to read.
+ * @param iCounter Counter index (0 to mCounters-1).
+ * @param oCount Pointer to write the count to.
+ */
+void SharedCounter_get(tSharedCounter *ioCounterPtr, const uint32_t iCounter, uint64_t *oCount);
+
+#endif // SHARED_COUNTER_H
@@ -0,0 +1,25 @@
+#ifndef SUMMING_COUNTER_H
+#define SUMMING_COUNTER_H
+
+#include <counter_api.h>
+#include <stdint.h>
+
+/**
+ * @brief Options for SummingCounter.
+ */
+typedef struct
+{
+    uint32_t mThreads; // Number of threads that will use this counter
+} tSummingCounter_options;
+
+/**
+ * @brief Global SummingCounter interface. Defined in SummingCounter.c.
+ *
+ * Each thread only adds to its own cache-line slot and get sums every slot, so
+ * increments never touch shared memory and reads cost O(threads). Increment for
+ * a given iThread must only be called by that thread, and reset must not race
+ * with updates.
+ */
+extern const tCounter_interface gSummingCounter_interface;
+
+#endif // SUMMING_COUNTER_H
@@ -0,0 +1,90 @@
+#ifndef TOP_K_H
+#define TOP_K_H
+
+#include <stdint.h>
+
+/**
+ * @brief Options for TopK.
+ */
+typedef struct
+{
+    uint32_t mThreads;       // Number of threads (local summaries) adding keys
+    uint32_t mCapacity;      // Keys tracked by the global summary (0: default 64)
+    uint32_t mLocalCapacity; // Distinct keys a thread collects before merging (0: mCapacity)
+} tTopK_options;
+
+/**
+ * @brief A tracked key. The true count lies in [mCount - mError, mCount].
+ */
+typedef struct
+{
+    uint64_t mKey;   // Key
+    uint64_t mCount; // Estimated count (never below the true count)
+    uint64_t mError; // Largest overestimate in mCount
+} tTopK_entry;
+
+/**
+ * @brief Heavy-hitters tracker (Space-Saving).
+ *
+ * Each thread counts keys exactly in a small private hash table. When the
+ * table holds mLocalCapacity distinct keys, the thread merges it into the
+ * global Space-Saving summary under a lock and starts over, the
+ * ApproximateCounter threshold idea applied to keys. Adds are lock-free and
+ * O(1) between merges; a merge costs O((mCapacity + mLocalCapacity) log) and
+ * happens at most once per mLocalCapacity adds. Queries merge the global
+ * summary with every thread's current table.
+ */
+typedef struct __tTopK tTopK;
+
+/**
+ * @brief Allocate an empty tracker.
+ *
+ * @param iOptionsPtr Pointer to tTopK_options (required).
+ * @return Pointer to new tracker.
+ */
+tTopK *TopK_create(const tTopK_options *iOptionsPtr);
+
+/**
+ * @brief Free the tracker.
+ *
+ * @param ioTopKPtr Tracker to destroy.
+ */
+void TopK_destroy(tTopK *ioTopKPtr);
+
+/**
+ * @brief Forget all keys. Writers must be quiescent.
+ *
+ * @param ioTopKPtr Tracker to reset.
+ */
+void TopK_reset(tTopK *ioTopKPtr);
+
+/**
+ * @brief Merge a thread's local table into the global summary. Called by the
+ *        owning thread.
+ *
+ * @param ioTopKPtr Tracker instance.
+ * @param iThread Thread ID to flush.
+ */
+void TopK_flush(tTopK *ioTopKPtr, const uint32_t iThread);
+
+/**
+ * @brief Count iAmount occurrences of a key.
+ *
+ * @param ioTopKPtr Tracker to update.
+ * @param iThread Thread ID (0 to mThreads-1).
+ * @param iKey Key to count.
+ * @param iAmount Occurrences to add.
+ */
+void TopK_add(tTopK *ioTopKPtr, const uint32_t iThread, const uint64_t iKey, const uint32_t iAmount);
+
+/**
+ * @brief The heaviest keys, by estimated count, highest first.
+ *
+ * @param ioTopKPtr Tracker to query.
+ * @param iK Number of entries wanted (at most mCapacity are tracked).
+ * @param oEntries Array of at least iK entries to fill.
+ * @return Number of entries written.
+ */
+uint32_t TopK_query(tTopK *ioTopKPtr, const uint32_t iK, tTopK_entry *oEntries);
+
+#endif // TOP_K_H
@@ -0,0 +1,77 @@
+#ifndef WINDOW_COUNTER_H
+#define WINDOW_COUNTER_H
+
+#include <stdint.h>
+
+/**
+ * @brief Options for WindowCounter.
+ */
+typedef struct
+{
+    uint32_t mThreads;  // Number of threads (rings) counting events
+    uint32_t mBucketMs; // Width of a time bucket (ms); queries are this coarse
+    uint32_t mBuckets;  // Buckets per ring; the longest window is mBuckets * mBucketMs
+} tWindowCounter_options;
+
+/**
+ * @brief Sliding-window event counter ("events in the last W ms").
+ *
+ * Each thread counts into its own ring of time buckets, each tagged with the
+ * bucket number (monotonic time / mBucketMs) it currently holds; an add that
+ * lands on a stale bucket recycles it. Writes stay on the owner's cache lines
+ * as with ApproximateCounter's mLocal; queries merge the buckets of every
+ * ring that fall inside the window. With buckets of 10 ms or more the coarse
+ * monotonic clock is used, which is cheaper to read.
+ */
+typedef struct __tWindowCounter tWindowCounter;
+
+/**
+ * @brief Allocate an empty windowed counter.
+ *
+ * @param iOptionsPtr Pointer to tWindowCounter_options (required).
+ * @return Pointer to new counter.
+ */
+tWindowCounter *WindowCounter_create(const tWindowCounter_options *iOptionsPtr);
+
+/**
+ * @brief Free the counter.
+ *
+ * @param ioCounterPtr Counter to destroy.
+ */
+void WindowCounter_destroy(tWindowCounter *ioCounterPtr);
+
+/**
+ * @brief Forget all events. Writers must be quiescent.
+ *
+ * @param ioCounterPtr Counter to reset.
+ */
+void WindowCounter_reset(tWindowCounter *ioCounterPtr);
+
+/**
+ * @brief No-op: rings are read in place, there is nothing to flush.
+ *
+ * @param ioCounterPtr Counter instance.
+ * @param iThread Thread ID.
+ */
+void WindowCounter_flush(tWindowCounter *ioCounterPtr, const uint32_t iThread);
+
+/**
+ * @brief Count iAmount events now.
+ *
+ * @param ioCounterPtr Counter to update.
+ * @param iThread Thread ID (0 to mThreads-1).
+ * @param iAmount Number of events.
+ */
+void WindowCounter_add(tWindowCounter *ioCounterPtr, const uint32_t iThread, const uint32_t iAmount);
+
+/**
+ * @brief Events in the last iWindowMs milliseconds, rounded up to whole
+ *        buckets (the current, partly filled bucket included).
+ *
+ * @param ioCounterPtr Counter to read.
+ * @param iWindowMs Window length, at most mBuckets * mBucketMs.
+ * @return Number of events in the window.
+ */
+uint64_t WindowCounter_count(tWindowCounter *ioCounterPtr, const uint32_t iWindowMs);
+
+#endif // WINDOW_COUNTER_H
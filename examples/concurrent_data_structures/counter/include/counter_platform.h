@@ -0,0 +1,55 @@
+#ifndef COUNTER_PLATFORM_H
+#define COUNTER_PLATFORM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Platform constants shared by the counter implementations.
+ */
+enum
+{
+    kCounter_cacheLineSize = 64 // Size of a cache line (bytes) on the targets we run on
+};
+
+/**
+ * @brief Hint to the CPU that the caller is in a spin-wait loop.
+ *
+ * Lowers power and frees pipeline resources for a sibling hyperthread while
+ * the caller waits on a contended cache line.
+ */
+static inline void Counter_cpuRelax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#else
+    __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
+/**
+ * @brief Round a byte count up to whole cache lines, so that per-thread rows
+ *        laid out back to back never share a line.
+ */
+static inline size_t Counter_cacheLineRound(size_t iBytes)
+{
+    return (iBytes + kCounter_cacheLineSize - 1) & ~(size_t)(kCounter_cacheLineSize - 1);
+}
+
+/**
+ * @brief 64-bit finalizer of MurmurHash3 (fmix64). Spreads a key over all 64
+ *        bits, so its low bits can index a table directly.
+ */
+static inline uint64_t Counter_hash64(uint64_t iKey)
+{
+    iKey ^= iKey >> 33;
+    iKey *= 0xff51afd7ed558ccdull;
+    iKey ^= iKey >> 33;
+    iKey *= 0xc4ceb9fe1a85ec53ull;
+    iKey ^= iKey >> 33;
+    return iKey;
+}
+
+#endif // COUNTER_PLATFORM_H
@@ -1,23 +1,92 @@
 #include <ApproximateCounter.h>
 #include <assert.h>
+#include <counter_platform.h>
 #include <memory.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <time.h>
+
+/**
+ * @brief Per-thread slot of the padded layout. Aligned so that no two threads'
+ *        slots share a cache line.
+ */
+typedef struct
+{
+    alignas(kCounter_cacheLineSize) _Atomic uint32_t mLocal; // local count
+    uint32_t mLimit;                                         // local count threshold
+    pthread_mutex_t mLlock;                                  // local count lock
+} tApproximateCounter_slot;
 
 /**
  * @brief Scalable counter using per-thread local counters and periodic flushing.
+ *
+ * mLocal, mLimit and mLlock point at the first thread's count, threshold and
+ * lock; thread i's entries are mLocalStride, mLimitStride and mLlockStride
+ * bytes further on. The dense layout uses packed arrays, the padded layout one
+ * array of tApproximateCounter_slot (held in mSlots). A thread's mLimit is
+ * only written by the thread itself, and stays at mThreshold unless the
+ * adaptive threshold is enabled.
+ *
+ * Counts are atomics so the lock-free owner mode can share the code; under the
+ * locks they are accessed with relaxed loads and stores, i.e. plain moves.
  */
 typedef struct
 {
-    tCounter_instance mBase; // base class (must be first field)
-    uint32_t mGlobal;        // global count
-    pthread_mutex_t mGlock;  // global count lock
-    uint32_t mThreads;       // number of local counter threads
-    uint32_t *mLocal;        // local counts (one per thread)
-    pthread_mutex_t *mLlock; // local counts locks (one per thread)
-    uint32_t mThreshold;     // update frequency
+    tCounter_instance mBase;            // base class (must be first field)
+    _Atomic uint32_t mGlobal;           // global count
+    pthread_mutex_t mGlock;             // global count lock
+    uint32_t mThreads;                  // number of local counter threads
+    _Atomic uint32_t *mLocal;           // local counts (one per thread)
+    pthread_mutex_t *mLlock;            // local counts locks (one per thread)
+    uint32_t *mLimit;                   // local count thresholds (one per thread)
+    size_t mLocalStride;                // bytes between two threads' local counts
+    size_t mLimitStride;                // bytes between two threads' thresholds
+    size_t mLlockStride;                // bytes between two threads' local locks
+    tApproximateCounter_slot *mSlots;   // padded slots (NULL for the dense layout)
+    tApproximateCounter_layout mLayout; // per-thread slot layout
+    tApproximateCounter_sync mSync;     // per-thread slot synchronization
+    uint32_t mThreshold;                // update frequency (adaptive lower bound)
+    uint32_t mMaxThreshold;             // adaptive upper bound (0: fixed threshold)
+    uint32_t mFlushPeriodMs;            // background flush period (0: none)
+    pthread_t mFlusher;                 // background flusher thread
+    pthread_mutex_t mFlusherLock;       // protects mFlusherStop, held by each sweep
+    pthread_cond_t mFlusherWake;        // wakes the flusher early to stop it
+    int mFlusherStop;                   // flusher shutdown request
 } tApproximateCounter_instance;
 
+static void *ApproximateCounter_flusher(void *ioCounterPtr);
+
+/**
+ * @brief Address of a thread's local count.
+ */
+static inline _Atomic uint32_t *ApproximateCounter_local(const tApproximateCounter_instance *iCounterPtr,
+                                                         const uint32_t iThread)
+{
+    assert(iThread < iCounterPtr->mThreads); // see DynamicCounter for unregistered threads
+    return (_Atomic uint32_t *)((char *)iCounterPtr->mLocal + iThread * iCounterPtr->mLocalStride);
+}
+
+/**
+ * @brief Address of a thread's local count threshold.
+ */
+static inline uint32_t *ApproximateCounter_limit(const tApproximateCounter_instance *iCounterPtr,
+                                                 const uint32_t iThread)
+{
+    return (uint32_t *)((char *)iCounterPtr->mLimit + iThread * iCounterPtr->mLimitStride);
+}
+
+/**
+ * @brief Address of a thread's local count lock.
+ */
+static inline pthread_mutex_t *ApproximateCounter_llock(const tApproximateCounter_instance *iCounterPtr,
+                                                        const uint32_t iThread)
+{
+    return (pthread_mutex_t *)((char *)iCounterPtr->mLlock + iThread * iCounterPtr->mLlockStride);
+}
+
 /**
  * @brief Initialize the approximate counter.
  *
@@ -31,6 +100,11 @@ static tCounter_instance *ApproximateCounter_create(const tCounter_instance *iBa
     uint32_t aThread;
     uint32_t aThreshold;
     uint32_t aThreads;
+    tApproximateCounter_layout aLayout;
+    tApproximateCounter_sync aSync;
+    uint32_t aFlushPeriodMs;
+    uint32_t aMaxThreshold;
+    pthread_condattr_t aCondAttr;
     tApproximateCounter_options *aOptionsPtr;
     tApproximateCounter_instance *aCounterPtr;
 
@@ -42,12 +116,24 @@ static tCounter_instance *ApproximateCounter_create(const tCounter_instance *iBa
         aOptionsPtr = (tApproximateCounter_options *)iOptionsPtr;
         aThreshold = aOptionsPtr->mThreshold;
         aThreads = aOptionsPtr->mThreads;
+        aLayout = aOptionsPtr->mLayout;
+        aSync = aOptionsPtr->mSync;
+        aFlushPeriodMs = aOptionsPtr->mFlushPeriodMs;
+        aMaxThreshold = aOptionsPtr->mMaxThreshold;
     }
     else
     {
         // use defaults
         aThreshold = 1024;
         aThreads = 8;
+        aLayout = kApproximateCounter_layoutDense;
+        aSync = kApproximateCounter_syncLocked;
+        aFlushPeriodMs = 0;
+        aMaxThreshold = 0;
+    }
+    if (aMaxThreshold != 0 && aMaxThreshold < aThreshold)
+    {
+        aMaxThreshold = aThreshold;
     }
 
     // allocate approximate counter instance
@@ -59,13 +145,38 @@ static tCounter_instance *ApproximateCounter_create(const tCounter_instance *iBa
     memcpy(aCounterPtr, iBasePtr, sizeof(tCounter_instance));
 
     // initialize counter shallow state
-    aCounterPtr->mGlobal = 0;
+    atomic_init(&aCounterPtr->mGlobal, 0);
     aCounterPtr->mThreshold = aThreshold;
     aCounterPtr->mThreads = aThreads;
+    aCounterPtr->mLayout = aLayout;
+    aCounterPtr->mSync = aSync;
+    aCounterPtr->mFlushPeriodMs = aFlushPeriodMs;
+    aCounterPtr->mMaxThreshold = aMaxThreshold;
 
     // allocate counter heap state
-    aCounterPtr->mLocal = malloc(aThreads * sizeof(uint32_t));
-    aCounterPtr->mLlock = malloc(aThreads * sizeof(pthread_mutex_t));
+    if (aLayout == kApproximateCounter_layoutPadded)
+    {
+        aCounterPtr->mSlots = aligned_alloc(kCounter_cacheLineSize,
+                                            aThreads * sizeof(tApproximateCounter_slot));
+        assert(aCounterPtr->mSlots != NULL);
+        aCounterPtr->mLocal = &aCounterPtr->mSlots[0].mLocal;
+        aCounterPtr->mLimit = &aCounterPtr->mSlots[0].mLimit;
+        aCounterPtr->mLlock = &aCounterPtr->mSlots[0].mLlock;
+        aCounterPtr->mLocalStride = sizeof(tApproximateCounter_slot);
+        aCounterPtr->mLimitStride = sizeof(tApproximateCounter_slot);
+        aCounterPtr->mLlockStride = sizeof(tApproximateCounter_slot);
+    }
+    else
+    {
+        aCounterPtr->mSlots = NULL;
+        aCounterPtr->mLocal = malloc(aThreads * sizeof(_Atomic uint32_t));
+        aCounterPtr->mLimit = malloc(aThreads * sizeof(uint32_t));
+        aCounterPtr->mLlock = malloc(aThreads * sizeof(pthread_mutex_t));
+        assert(aCounterPtr->mLocal != NULL && aCounterPtr->mLimit != NULL && aCounterPtr->mLlock != NULL);
+        aCounterPtr->mLocalStride = sizeof(_Atomic uint32_t);
+        aCounterPtr->mLimitStride = sizeof(uint32_t);
+        aCounterPtr->mLlockStride = sizeof(pthread_mutex_t);
+    }
 
     // initialize global lock
     aStatusCode = pthread_mutex_init(&aCounterPtr->mGlock, NULL);
@@ -74,8 +185,24 @@ static tCounter_instance *ApproximateCounter_create(const tCounter_instance *iBa
     // initialize local locks
     for (aThread = 0; aThread < aThreads; ++aThread)
     {
-        aCounterPtr->mLocal[aThread] = 0;
-        aStatusCode = pthread_mutex_init(&aCounterPtr->mLlock[aThread], NULL);
+        atomic_init(ApproximateCounter_local(aCounterPtr, aThread), 0);
+        *ApproximateCounter_limit(aCounterPtr, aThread) = aThreshold;
+        aStatusCode = pthread_mutex_init(ApproximateCounter_llock(aCounterPtr, aThread), NULL);
+        assert(aStatusCode == 0);
+    }
+
+    // start the background flusher
+    if (aFlushPeriodMs != 0)
+    {
+        aCounterPtr->mFlusherStop = 0;
+        aStatusCode = pthread_mutex_init(&aCounterPtr->mFlusherLock, NULL);
+        assert(aStatusCode == 0);
+        pthread_condattr_init(&aCondAttr);
+        pthread_condattr_setclock(&aCondAttr, CLOCK_MONOTONIC);
+        aStatusCode = pthread_cond_init(&aCounterPtr->mFlusherWake, &aCondAttr);
+        assert(aStatusCode == 0);
+        pthread_condattr_destroy(&aCondAttr);
+        aStatusCode = pthread_create(&aCounterPtr->mFlusher, NULL, ApproximateCounter_flusher, aCounterPtr);
         assert(aStatusCode == 0);
     }
 
@@ -91,9 +218,7 @@ static void ApproximateCounter_destroy(tCounter_instance *ioInstancePtr)
 {
     uint32_t aThread;
     uint32_t aThreads;
-    uint32_t *aLocal;
     pthread_mutex_t *aGlock;
-    pthread_mutex_t *aLlock;
     tApproximateCounter_instance *aCounterPtr;
 
     if (ioInstancePtr == NULL)
@@ -103,23 +228,44 @@ static void ApproximateCounter_destroy(tCounter_instance *ioInstancePtr)
 
     aCounterPtr = (tApproximateCounter_instance *)ioInstancePtr;
 
+    // stop the background flusher before tearing down the slots
+    if (aCounterPtr->mFlushPeriodMs != 0)
+    {
+        pthread_mutex_lock(&aCounterPtr->mFlusherLock);
+        aCounterPtr->mFlusherStop = 1;
+        pthread_cond_signal(&aCounterPtr->mFlusherWake);
+        pthread_mutex_unlock(&aCounterPtr->mFlusherLock);
+        pthread_join(aCounterPtr->mFlusher, NULL);
+        pthread_cond_destroy(&aCounterPtr->mFlusherWake);
+        pthread_mutex_destroy(&aCounterPtr->mFlusherLock);
+    }
+
     aGlock = &aCounterPtr->mGlock;
-    aLocal = aCounterPtr->mLocal;
-    aLlock = aCounterPtr->mLlock;
     aThreads = aCounterPtr->mThreads;
     for (aThread = 0; aThread < aThreads; ++aThread)
     {
-        pthread_mutex_destroy(&aLlock[aThread]);
+        pthread_mutex_destroy(ApproximateCounter_llock(aCounterPtr, aThread));
     }
     pthread_mutex_destroy(aGlock);
-    free(aLocal);
-    free(aLlock);
+    if (aCounterPtr->mSlots != NULL)
+    {
+        free(aCounterPtr->mSlots);
+    }
+    else
+    {
+        free(aCounterPtr->mLocal);
+        free(aCounterPtr->mLimit);
+        free(aCounterPtr->mLlock);
+    }
     free(aCounterPtr);
 }
 
 /**
  * @brief Reset all counters to zero.
  *
+ * In owner mode there are no locks to quiesce the writers with, so the caller
+ * must make sure no thread is updating the counter.
+ *
  * @param ioInstancePtr Counter to reset.
  */
 static void ApproximateCounter_reset(tCounter_instance *ioInstancePtr)
@@ -138,18 +284,39 @@ static void ApproximateCounter_reset(tCounter_instance *ioInstancePtr)
     // get number of threads parameter of the instance
     aThreads = aCounterPtr->mThreads;
 
-    // acquire all locks
-    pthread_mutex_lock(&aCounterPtr->mGlock);
+    if (aCounterPtr->mSync == kApproximateCounter_syncOwner)
+    {
+        // wait out a background sweep so none straddles the reset
+        if (aCounterPtr->mFlushPeriodMs != 0)
+        {
+            pthread_mutex_lock(&aCounterPtr->mFlusherLock);
+        }
+        for (aThread = 0; aThread < aThreads; ++aThread)
+        {
+            atomic_store_explicit(ApproximateCounter_local(aCounterPtr, aThread), 0, memory_order_relaxed);
+            *ApproximateCounter_limit(aCounterPtr, aThread) = aCounterPtr->mThreshold;
+        }
+        atomic_store_explicit(&aCounterPtr->mGlobal, 0, memory_order_release);
+        if (aCounterPtr->mFlushPeriodMs != 0)
+        {
+            pthread_mutex_unlock(&aCounterPtr->mFlusherLock);
+        }
+        return;
+    }
+
+    // acquire all locks, local ones first like increment and flush do
     for (aThread = 0; aThread < aThreads; ++aThread)
     {
-        pthread_mutex_lock(&aCounterPtr->mLlock[aThread]);
+        pthread_mutex_lock(ApproximateCounter_llock(aCounterPtr, aThread));
     }
+    pthread_mutex_lock(&aCounterPtr->mGlock);
     // reset state and release locks
-    aCounterPtr->mGlobal = 0;
+    atomic_store_explicit(&aCounterPtr->mGlobal, 0, memory_order_relaxed);
     for (aThread = 0; aThread < aThreads; ++aThread)
     {
-        aCounterPtr->mLocal[aThread] = 0;
-        pthread_mutex_unlock(&aCounterPtr->mLlock[aThread]);
+        atomic_store_explicit(ApproximateCounter_local(aCounterPtr, aThread), 0, memory_order_relaxed);
+        *ApproximateCounter_limit(aCounterPtr, aThread) = aCounterPtr->mThreshold;
+        pthread_mutex_unlock(ApproximateCounter_llock(aCounterPtr, aThread));
     }
     pthread_mutex_unlock(&aCounterPtr->mGlock);
 }
@@ -157,12 +324,18 @@ static void ApproximateCounter_reset(tCounter_instance *ioInstancePtr)
 /**
  * @brief Flush thread's local count to global counter.
  *
+ * In owner mode the slot is drained with an atomic exchange and added to the
+ * global count with a fetch_add; no lock is taken.
+ *
  * @param ioInstancePtr Counter instance.
  * @param iThread Thread ID to flush.
  */
 static void ApproximateCounter_flush(tCounter_instance *ioInstancePtr,
                                      const uint32_t iThread)
 {
+    uint32_t aCount;
+    _Atomic uint32_t *aLocal;
+    pthread_mutex_t *aLlock;
     tApproximateCounter_instance *aCounterPtr;
 
     if (ioInstancePtr == NULL)
@@ -171,18 +344,151 @@ static void ApproximateCounter_flush(tCounter_instance *ioInstancePtr,
     }
 
     aCounterPtr = (tApproximateCounter_instance *)ioInstancePtr;
+    aLocal = ApproximateCounter_local(aCounterPtr, iThread);
+
+    if (aCounterPtr->mSync == kApproximateCounter_syncOwner)
+    {
+        aCount = atomic_exchange_explicit(aLocal, 0, memory_order_relaxed);
+        if (aCount != 0)
+        {
+            atomic_fetch_add_explicit(&aCounterPtr->mGlobal, aCount, memory_order_release);
+        }
+        return;
+    }
+
+    aLlock = ApproximateCounter_llock(aCounterPtr, iThread);
 
-    pthread_mutex_lock(&aCounterPtr->mLlock[iThread]);
+    pthread_mutex_lock(aLlock);
     pthread_mutex_lock(&aCounterPtr->mGlock);
-    aCounterPtr->mGlobal += aCounterPtr->mLocal[iThread];
+    aCount = atomic_load_explicit(aLocal, memory_order_relaxed);
+    atomic_store_explicit(&aCounterPtr->mGlobal,
+                          atomic_load_explicit(&aCounterPtr->mGlobal, memory_order_relaxed) + aCount,
+                          memory_order_relaxed);
     pthread_mutex_unlock(&aCounterPtr->mGlock);
-    aCounterPtr->mLocal[iThread] = 0;
-    pthread_mutex_unlock(&aCounterPtr->mLlock[iThread]);
+    atomic_store_explicit(aLocal, 0, memory_order_relaxed);
+    pthread_mutex_unlock(aLlock);
+}
+
+/**
+ * @brief Adjust a thread's threshold after a threshold flush (adaptive mode).
+ *
+ * @param iCounterPtr Counter the thread belongs to.
+ * @param ioLimitPtr The thread's threshold.
+ * @param iContended Whether the flush found the global count contended.
+ */
+static inline void ApproximateCounter_adapt(const tApproximateCounter_instance *iCounterPtr,
+                                            uint32_t *ioLimitPtr,
+                                            int iContended)
+{
+    uint32_t aLimit;
+
+    aLimit = *ioLimitPtr;
+    if (iContended)
+    {
+        aLimit = (aLimit > iCounterPtr->mMaxThreshold / 2) ? iCounterPtr->mMaxThreshold : 2 * aLimit;
+    }
+    else
+    {
+        aLimit -= aLimit / 8;
+        if (aLimit < iCounterPtr->mThreshold)
+        {
+            aLimit = iCounterPtr->mThreshold;
+        }
+    }
+    *ioLimitPtr = aLimit;
+}
+
+/**
+ * @brief Add a drained local count to the global count without a lock (owner
+ *        mode). In adaptive mode a first CAS attempt probes for contention.
+ *
+ * @param ioCounterPtr Counter to update.
+ * @param ioLimitPtr The flushing thread's threshold.
+ * @param iCount Count drained from the thread's slot.
+ */
+static inline void ApproximateCounter_addGlobal(tApproximateCounter_instance *ioCounterPtr,
+                                                uint32_t *ioLimitPtr,
+                                                uint32_t iCount)
+{
+    uint32_t aExpected;
+
+    if (ioCounterPtr->mMaxThreshold != 0)
+    {
+        aExpected = atomic_load_explicit(&ioCounterPtr->mGlobal, memory_order_relaxed);
+        if (atomic_compare_exchange_strong_explicit(&ioCounterPtr->mGlobal,
+                                                    &aExpected,
+                                                    aExpected + iCount,
+                                                    memory_order_release,
+                                                    memory_order_relaxed))
+        {
+            ApproximateCounter_adapt(ioCounterPtr, ioLimitPtr, 0);
+            return;
+        }
+        ApproximateCounter_adapt(ioCounterPtr, ioLimitPtr, 1);
+    }
+    atomic_fetch_add_explicit(&ioCounterPtr->mGlobal, iCount, memory_order_release);
+}
+
+/**
+ * @brief Background flusher thread. Flushes every slot once per
+ *        mFlushPeriodMs until the counter is destroyed.
+ *
+ * @param ioCounterPtr The tApproximateCounter_instance to flush.
+ */
+static void *ApproximateCounter_flusher(void *ioCounterPtr)
+{
+    uint32_t aThread;
+    struct timespec aDeadline;
+    tApproximateCounter_instance *aCounterPtr;
+
+    aCounterPtr = (tApproximateCounter_instance *)ioCounterPtr;
+
+    clock_gettime(CLOCK_MONOTONIC, &aDeadline);
+    pthread_mutex_lock(&aCounterPtr->mFlusherLock);
+    while (!aCounterPtr->mFlusherStop)
+    {
+        aDeadline.tv_sec += aCounterPtr->mFlushPeriodMs / 1000;
+        aDeadline.tv_nsec += (long)(aCounterPtr->mFlushPeriodMs % 1000) * 1000000L;
+        if (aDeadline.tv_nsec >= 1000000000L)
+        {
+            aDeadline.tv_sec += 1;
+            aDeadline.tv_nsec -= 1000000000L;
+        }
+
+        // sleep until the deadline unless asked to stop
+        while (!aCounterPtr->mFlusherStop &&
+               pthread_cond_timedwait(&aCounterPtr->mFlusherWake, &aCounterPtr->mFlusherLock, &aDeadline) == 0)
+        {
+        }
+        if (aCounterPtr->mFlusherStop)
+        {
+            break;
+        }
+
+        // sweep under the lock so a reset cannot land between draining a
+        // slot and adding it to the global count
+        for (aThread = 0; aThread < aCounterPtr->mThreads; ++aThread)
+        {
+            ApproximateCounter_flush((tCounter_instance *)aCounterPtr, aThread);
+        }
+    }
+    pthread_mutex_unlock(&aCounterPtr->mFlusherLock);
+
+    return NULL;
 }
 
 /**
  * @brief Increment thread-local counter, flushing to global when threshold is reached.
  *
+ * In owner mode the local update is a relaxed load and store on the caller's
+ * own slot and the threshold flush is a single fetch_add on the global count.
+ * With a background flusher the local update becomes a fetch_add, because the
+ * flusher may drain the slot at any time.
+ *
+ * In adaptive mode the threshold flush also probes the global count for
+ * contention (trylock, or a single CAS in owner mode) and adjusts the
+ * thread's threshold accordingly.
+ *
  * @param ioInstancePtr Counter to update.
  * @param iThread Thread ID (0 to num_threads-1).
  * @param iAmount Amount to add to local counter.
@@ -191,7 +497,10 @@ static void ApproximateCounter_increment(tCounter_instance *ioInstancePtr,
                                          const uint32_t iThread,
                                          const uint32_t iAmount)
 {
-
+    uint32_t aCount;
+    uint32_t *aLimit;
+    _Atomic uint32_t *aLocal;
+    pthread_mutex_t *aLlock;
     tApproximateCounter_instance *aCounterPtr;
 
     if (ioInstancePtr == NULL)
@@ -200,17 +509,64 @@ static void ApproximateCounter_increment(tCounter_instance *ioInstancePtr,
     }
 
     aCounterPtr = (tApproximateCounter_instance *)ioInstancePtr;
+    aLocal = ApproximateCounter_local(aCounterPtr, iThread);
+    aLimit = ApproximateCounter_limit(aCounterPtr, iThread);
 
-    pthread_mutex_lock(&aCounterPtr->mLlock[iThread]);
-    aCounterPtr->mLocal[iThread] += iAmount;
-    if (aCounterPtr->mLocal[iThread] >= aCounterPtr->mThreshold)
+    if (aCounterPtr->mSync == kApproximateCounter_syncOwner && aCounterPtr->mFlushPeriodMs != 0)
     {
-        pthread_mutex_lock(&aCounterPtr->mGlock);
-        aCounterPtr->mGlobal += aCounterPtr->mLocal[iThread];
+        // the flusher drains the slot concurrently, so the update must be a
+        // read-modify-write (still uncontended and cache-local)
+        aCount = atomic_fetch_add_explicit(aLocal, iAmount, memory_order_relaxed) + iAmount;
+        if (aCount >= *aLimit)
+        {
+            aCount = atomic_exchange_explicit(aLocal, 0, memory_order_relaxed);
+            ApproximateCounter_addGlobal(aCounterPtr, aLimit, aCount);
+        }
+        return;
+    }
+
+    if (aCounterPtr->mSync == kApproximateCounter_syncOwner)
+    {
+        aCount = atomic_load_explicit(aLocal, memory_order_relaxed) + iAmount;
+        if (aCount >= *aLimit)
+        {
+            atomic_store_explicit(aLocal, 0, memory_order_relaxed);
+            ApproximateCounter_addGlobal(aCounterPtr, aLimit, aCount);
+        }
+        else
+        {
+            atomic_store_explicit(aLocal, aCount, memory_order_relaxed);
+        }
+        return;
+    }
+
+    aLlock = ApproximateCounter_llock(aCounterPtr, iThread);
+
+    pthread_mutex_lock(aLlock);
+    aCount = atomic_load_explicit(aLocal, memory_order_relaxed) + iAmount;
+    if (aCount >= *aLimit)
+    {
+        if (aCounterPtr->mMaxThreshold == 0)
+        {
+            pthread_mutex_lock(&aCounterPtr->mGlock);
+        }
+        else if (pthread_mutex_trylock(&aCounterPtr->mGlock) == 0)
+        {
+            ApproximateCounter_adapt(aCounterPtr, aLimit, 0);
+        }
+        else
+        {
+            ApproximateCounter_adapt(aCounterPtr, aLimit, 1);
+            pthread_mutex_lock(&aCounterPtr->mGlock);
+        }
+        atomic_store_explicit(&aCounterPtr->mGlobal,
+                              atomic_load_explicit(&aCounterPtr->mGlobal, memory_order_relaxed) + aCount,
+                              memory_order_relaxed);
         pthread_mutex_unlock(&aCounterPtr->mGlock);
-        aCounterPtr->mLocal[iThread] = 0;
+        aCount = 0;
     }
-    pthread_mutex_unlock(&aCounterPtr->mLlock[iThread]);
+    atomic_store_explicit(aLocal, aCount, memory_order_relaxed);
+    pthread_mutex_unlock(aLlock);
 }
 
 /**
@@ -233,8 +589,14 @@ static void ApproximateCounter_get(tCounter_instance *ioInstancePtr,
 
     aCounterPtr = (tApproximateCounter_instance *)ioInstancePtr;
 
+    if (aCounterPtr->mSync == kApproximateCounter_syncOwner)
+    {
+        *oCount = atomic_load_explicit(&aCounterPtr->mGlobal, memory_order_acquire);
+        return;
+    }
+
     pthread_mutex_lock(&aCounterPtr->mGlock);
-    *oCount = aCounterPtr->mGlobal;
+    *oCount = atomic_load_explicit(&aCounterPtr->mGlobal, memory_order_relaxed);
     pthread_mutex_unlock(&aCounterPtr->mGlock);
 }
 
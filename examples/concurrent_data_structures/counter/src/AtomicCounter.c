@@ -0,0 +1,206 @@
+#include <AtomicCounter.h>
+#include <assert.h>
+#include <counter_platform.h>
+#include <memory.h>
+#include <sched.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @brief Exact lock-free counter backed by a single atomic word.
+ *
+ * The count lives on its own cache line so the configuration fields (read on
+ * every increment) are never invalidated by the updates.
+ */
+typedef struct
+{
+    tCounter_instance mBase;         // base class (must be first field)
+    tAtomicCounter_backoff mBackoff; // contention backoff strategy
+    uint32_t mMaxSpins;              // exponential spin cap
+
+    alignas(kCounter_cacheLineSize) _Atomic uint32_t mGlobal; // global count
+} tAtomicCounter_instance;
+
+/**
+ * @brief Allocate and initialize the atomic counter.
+ *
+ * @param iBasePtr Counter base to initialize.
+ * @param iOptionsPtr Pointer to tAtomicCounter_options, or NULL for a plain
+ *                    fetch_add counter.
+ * @return Pointer to new counter instance.
+ */
+static tCounter_instance *AtomicCounter_create(const tCounter_instance *iBasePtr, const void *iOptionsPtr)
+{
+    const tAtomicCounter_options *aOptionsPtr;
+    tAtomicCounter_instance *aCounterPtr;
+
+    assert(iBasePtr != NULL); // required parameter
+
+    // allocate atomic counter instance (cache-line aligned, see instance doc)
+    aCounterPtr = aligned_alloc(kCounter_cacheLineSize, sizeof(tAtomicCounter_instance));
+    assert(aCounterPtr != NULL);
+    memset(aCounterPtr, 0, sizeof(tAtomicCounter_instance)); // blank slate
+
+    // copy the base into the instance
+    memcpy(aCounterPtr, iBasePtr, sizeof(tCounter_instance));
+
+    // get options
+    if (iOptionsPtr != NULL)
+    {
+        aOptionsPtr = (const tAtomicCounter_options *)iOptionsPtr;
+        aCounterPtr->mBackoff = aOptionsPtr->mBackoff;
+        aCounterPtr->mMaxSpins = aOptionsPtr->mMaxSpins;
+    }
+    else
+    {
+        // use defaults
+        aCounterPtr->mBackoff = kAtomicCounter_backoffNone;
+        aCounterPtr->mMaxSpins = 1024;
+    }
+    if (aCounterPtr->mMaxSpins == 0)
+    {
+        aCounterPtr->mMaxSpins = 1;
+    }
+
+    // initialize counter state
+    atomic_init(&aCounterPtr->mGlobal, 0);
+
+    return (tCounter_instance *)aCounterPtr;
+}
+
+/**
+ * @brief Clean up counter resources. Free all memory allocated in _create.
+ *
+ * @param ioInstancePtr Counter instance to destroy.
+ */
+static void AtomicCounter_destroy(tCounter_instance *ioInstancePtr)
+{
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    free(ioInstancePtr);
+}
+
+/**
+ * @brief Reset counter to zero.
+ *
+ * @param ioInstancePtr Counter to reset.
+ */
+static void AtomicCounter_reset(tCounter_instance *ioInstancePtr)
+{
+    tAtomicCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tAtomicCounter_instance *)ioInstancePtr;
+
+    atomic_store_explicit(&aCounterPtr->mGlobal, 0, memory_order_release);
+}
+
+/**
+ * @brief Flush pending updates.
+ *
+ * No-op for atomic counter (all updates are immediate).
+ *
+ * @param ioInstancePtr Counter instance.
+ * @param iThread Ignored.
+ */
+static void AtomicCounter_flush(tCounter_instance *ioInstancePtr, const uint32_t iThread)
+{
+    // Do nothing - all updates are immediate for atomic counter
+}
+
+/**
+ * @brief Update counter by specified amount.
+ *
+ * With kAtomicCounter_backoffNone this is a single fetch_add. Otherwise the
+ * update is a compare-and-swap loop that backs off after every failed attempt
+ * so that contending cores stop hammering the line in lock-step.
+ *
+ * @param ioInstancePtr Counter to update.
+ * @param iThread Ignored (for API compatibility).
+ * @param iAmount Amount to add to counter.
+ */
+static void AtomicCounter_increment(tCounter_instance *ioInstancePtr,
+                                    const uint32_t iThread,
+                                    const uint32_t iAmount)
+{
+    uint32_t aExpected;
+    uint32_t aSpins;
+    uint32_t aSpin;
+    tAtomicCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tAtomicCounter_instance *)ioInstancePtr;
+
+    if (aCounterPtr->mBackoff == kAtomicCounter_backoffNone)
+    {
+        atomic_fetch_add_explicit(&aCounterPtr->mGlobal, iAmount, memory_order_relaxed);
+        return;
+    }
+
+    aSpins = 1;
+    aExpected = atomic_load_explicit(&aCounterPtr->mGlobal, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&aCounterPtr->mGlobal,
+                                                  &aExpected,
+                                                  aExpected + iAmount,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed))
+    {
+        if (aCounterPtr->mBackoff == kAtomicCounter_backoffYield)
+        {
+            sched_yield();
+            continue;
+        }
+
+        for (aSpin = 0; aSpin < aSpins; ++aSpin)
+        {
+            Counter_cpuRelax();
+        }
+        if (aSpins < aCounterPtr->mMaxSpins)
+        {
+            aSpins <<= 1;
+        }
+    }
+}
+
+/**
+ * @brief Get current counter value.
+ *
+ * @param ioInstancePtr Counter to read from.
+ * @param oCount Address to write count to.
+ */
+static void AtomicCounter_get(tCounter_instance *ioInstancePtr,
+                              uint32_t *oCount)
+{
+    tAtomicCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tAtomicCounter_instance *)ioInstancePtr;
+
+    *oCount = atomic_load_explicit(&aCounterPtr->mGlobal, memory_order_acquire);
+}
+
+const tCounter_interface gAtomicCounter_interface =
+    {
+        AtomicCounter_create,
+        AtomicCounter_destroy,
+        AtomicCounter_reset,
+        AtomicCounter_flush,
+        AtomicCounter_increment,
+        AtomicCounter_get};
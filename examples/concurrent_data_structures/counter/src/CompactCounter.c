@@ -0,0 +1,314 @@
+#include <CompactCounter.h>
+#include <assert.h>
+#include <counter_platform.h>
+#include <memory.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+struct __tCompactCounter_slab
+{
+    pthread_mutex_t mLock; // protects mFree
+    uint32_t mThreads;     // number of rows
+    uint32_t mCounters;    // slots per row
+    uint32_t mWidth;       // bytes per slot
+    size_t mRowBytes;      // bytes between rows (whole cache lines)
+    uint8_t *mSlotsPtr;    // per-thread rows, each slot only written by its owner
+    uint32_t *mFree;       // free counter ids
+    uint32_t mFreeCount;   // number of entries in mFree
+};
+
+/**
+ * @brief Sloppy counter whose local slots live in a shared slab.
+ */
+typedef struct
+{
+    tCounter_instance mBase;        // base class (must be first field)
+    _Atomic uint32_t mGlobal;       // global count
+    uint32_t mId;                   // column of this counter in the slab
+    uint32_t mThreshold;            // flush threshold, fits the slot width
+    tCompactCounter_slab *mSlabPtr; // slab holding the local slots
+} tCompactCounter_instance;
+
+/**
+ * @brief Address of a thread's slot for a counter.
+ */
+static inline void *CompactCounter_slot(const tCompactCounter_instance *iCounterPtr, const uint32_t iThread)
+{
+    const tCompactCounter_slab *aSlabPtr = iCounterPtr->mSlabPtr;
+
+    assert(iThread < aSlabPtr->mThreads);
+    return aSlabPtr->mSlotsPtr + iThread * aSlabPtr->mRowBytes + iCounterPtr->mId * aSlabPtr->mWidth;
+}
+
+tCompactCounter_slab *CompactCounter_createSlab(const tCompactCounter_slabOptions *iOptionsPtr)
+{
+    uint32_t aId;
+    int aStatusCode;
+    tCompactCounter_slab *aSlabPtr;
+
+    assert(iOptionsPtr != NULL);    // required parameter
+    assert(iOptionsPtr->mThreads);  // need at least one row
+    assert(iOptionsPtr->mCounters); // need room for at least one counter
+    assert(iOptionsPtr->mWidth == kCompactCounter_width8 || iOptionsPtr->mWidth == kCompactCounter_width16);
+
+    aSlabPtr = malloc(sizeof(tCompactCounter_slab));
+    assert(aSlabPtr != NULL);
+    memset(aSlabPtr, 0, sizeof(tCompactCounter_slab)); // blank slate
+
+    aStatusCode = pthread_mutex_init(&aSlabPtr->mLock, NULL);
+    assert(aStatusCode == 0);
+    aSlabPtr->mThreads = iOptionsPtr->mThreads;
+    aSlabPtr->mCounters = iOptionsPtr->mCounters;
+    aSlabPtr->mWidth = iOptionsPtr->mWidth;
+
+    aSlabPtr->mRowBytes = Counter_cacheLineRound(aSlabPtr->mCounters * aSlabPtr->mWidth);
+    aSlabPtr->mSlotsPtr = aligned_alloc(kCounter_cacheLineSize, aSlabPtr->mThreads * aSlabPtr->mRowBytes);
+    assert(aSlabPtr->mSlotsPtr != NULL);
+    memset(aSlabPtr->mSlotsPtr, 0, aSlabPtr->mThreads * aSlabPtr->mRowBytes);
+
+    // hand out low ids first, so live counters pack into the front of each row
+    aSlabPtr->mFree = malloc(aSlabPtr->mCounters * sizeof(uint32_t));
+    assert(aSlabPtr->mFree != NULL);
+    for (aId = 0; aId < aSlabPtr->mCounters; ++aId)
+    {
+        aSlabPtr->mFree[aId] = aSlabPtr->mCounters - 1 - aId;
+    }
+    aSlabPtr->mFreeCount = aSlabPtr->mCounters;
+
+    return aSlabPtr;
+}
+
+void CompactCounter_destroySlab(tCompactCounter_slab *ioSlabPtr)
+{
+    if (ioSlabPtr == NULL)
+    {
+        return;
+    }
+
+    assert(ioSlabPtr->mFreeCount == ioSlabPtr->mCounters); // counters still live
+    pthread_mutex_destroy(&ioSlabPtr->mLock);
+    free(ioSlabPtr->mSlotsPtr);
+    free(ioSlabPtr->mFree);
+    free(ioSlabPtr);
+}
+
+size_t CompactCounter_slotBytes(const tCompactCounter_slab *iSlabPtr)
+{
+    return iSlabPtr->mThreads * iSlabPtr->mRowBytes / iSlabPtr->mCounters;
+}
+
+/**
+ * @brief Allocate the counter and take a column of the slab.
+ *
+ * @param iBasePtr Counter base to initialize.
+ * @param iOptionsPtr Pointer to tCompactCounter_options (required).
+ * @return Pointer to new counter instance.
+ */
+static tCounter_instance *CompactCounter_create(const tCounter_instance *iBasePtr, const void *iOptionsPtr)
+{
+    uint32_t aThread;
+    uint32_t aLimit;
+    const tCompactCounter_options *aOptionsPtr;
+    tCompactCounter_slab *aSlabPtr;
+    tCompactCounter_instance *aCounterPtr;
+
+    assert(iBasePtr != NULL);    // required parameter
+    assert(iOptionsPtr != NULL); // the slab is not optional
+
+    // get options
+    aOptionsPtr = (const tCompactCounter_options *)iOptionsPtr;
+    aSlabPtr = aOptionsPtr->mSlabPtr;
+    assert(aSlabPtr != NULL);
+
+    aCounterPtr = malloc(sizeof(tCompactCounter_instance));
+    assert(aCounterPtr != NULL);
+    memset(aCounterPtr, 0, sizeof(tCompactCounter_instance)); // blank slate
+
+    // copy the base into the instance
+    memcpy(aCounterPtr, iBasePtr, sizeof(tCounter_instance));
+
+    // a slot must hold threshold - 1 plus one more add without wrapping, so
+    // flush at the slot's maximum value at the latest
+    aLimit = (aSlabPtr->mWidth == kCompactCounter_width8) ? UINT8_MAX : UINT16_MAX;
+    aCounterPtr->mThreshold = (aOptionsPtr->mThreshold > aLimit) ? aLimit : aOptionsPtr->mThreshold;
+    aCounterPtr->mThreshold = (aCounterPtr->mThreshold == 0) ? 1 : aCounterPtr->mThreshold;
+    aCounterPtr->mSlabPtr = aSlabPtr;
+    atomic_init(&aCounterPtr->mGlobal, 0);
+
+    pthread_mutex_lock(&aSlabPtr->mLock);
+    assert(aSlabPtr->mFreeCount != 0); // slab is full
+    aCounterPtr->mId = aSlabPtr->mFree[--aSlabPtr->mFreeCount];
+    pthread_mutex_unlock(&aSlabPtr->mLock);
+
+    // the previous owner of the column may have left counts behind
+    for (aThread = 0; aThread < aSlabPtr->mThreads; ++aThread)
+    {
+        memset(CompactCounter_slot(aCounterPtr, aThread), 0, aSlabPtr->mWidth);
+    }
+
+    return (tCounter_instance *)aCounterPtr;
+}
+
+/**
+ * @brief Give the counter's column back to the slab and free the counter.
+ *
+ * @param ioInstancePtr Counter instance to destroy.
+ */
+static void CompactCounter_destroy(tCounter_instance *ioInstancePtr)
+{
+    tCompactCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tCompactCounter_instance *)ioInstancePtr;
+
+    pthread_mutex_lock(&aCounterPtr->mSlabPtr->mLock);
+    aCounterPtr->mSlabPtr->mFree[aCounterPtr->mSlabPtr->mFreeCount++] = aCounterPtr->mId;
+    pthread_mutex_unlock(&aCounterPtr->mSlabPtr->mLock);
+    free(aCounterPtr);
+}
+
+/**
+ * @brief Reset the global count and the counter's slots to zero. Writers
+ *        must be quiescent.
+ *
+ * @param ioInstancePtr Counter to reset.
+ */
+static void CompactCounter_reset(tCounter_instance *ioInstancePtr)
+{
+    uint32_t aThread;
+    tCompactCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tCompactCounter_instance *)ioInstancePtr;
+
+    for (aThread = 0; aThread < aCounterPtr->mSlabPtr->mThreads; ++aThread)
+    {
+        if (aCounterPtr->mSlabPtr->mWidth == kCompactCounter_width8)
+        {
+            atomic_store_explicit((_Atomic uint8_t *)CompactCounter_slot(aCounterPtr, aThread), 0, memory_order_relaxed);
+        }
+        else
+        {
+            atomic_store_explicit((_Atomic uint16_t *)CompactCounter_slot(aCounterPtr, aThread), 0, memory_order_relaxed);
+        }
+    }
+    atomic_store_explicit(&aCounterPtr->mGlobal, 0, memory_order_release);
+}
+
+/**
+ * @brief Move a thread's local count to the global count. Called by the
+ *        owning thread.
+ *
+ * @param ioInstancePtr Counter instance.
+ * @param iThread Thread ID to flush.
+ */
+static void CompactCounter_flush(tCounter_instance *ioInstancePtr, const uint32_t iThread)
+{
+    uint32_t aCount;
+    tCompactCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tCompactCounter_instance *)ioInstancePtr;
+
+    if (aCounterPtr->mSlabPtr->mWidth == kCompactCounter_width8)
+    {
+        aCount = atomic_exchange_explicit((_Atomic uint8_t *)CompactCounter_slot(aCounterPtr, iThread), 0,
+                                          memory_order_relaxed);
+    }
+    else
+    {
+        aCount = atomic_exchange_explicit((_Atomic uint16_t *)CompactCounter_slot(aCounterPtr, iThread), 0,
+                                          memory_order_relaxed);
+    }
+    if (aCount != 0)
+    {
+        atomic_fetch_add_explicit(&aCounterPtr->mGlobal, aCount, memory_order_release);
+    }
+}
+
+/**
+ * @brief Add to the calling thread's slot, flushing to the global count when
+ *        the threshold is reached.
+ *
+ * @param ioInstancePtr Counter to update.
+ * @param iThread Thread ID (0 to num_threads-1) of the caller.
+ * @param iAmount Amount to add to counter.
+ */
+static void CompactCounter_increment(tCounter_instance *ioInstancePtr,
+                                     const uint32_t iThread,
+                                     const uint32_t iAmount)
+{
+    uint32_t aCount;
+    void *aSlotPtr;
+    tCompactCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tCompactCounter_instance *)ioInstancePtr;
+    aSlotPtr = CompactCounter_slot(aCounterPtr, iThread);
+
+    // the sum is formed in 32 bits and only stored back below the threshold,
+    // which fits the slot
+    if (aCounterPtr->mSlabPtr->mWidth == kCompactCounter_width8)
+    {
+        aCount = atomic_load_explicit((_Atomic uint8_t *)aSlotPtr, memory_order_relaxed) + iAmount;
+        atomic_store_explicit((_Atomic uint8_t *)aSlotPtr,
+                              (aCount < aCounterPtr->mThreshold) ? (uint8_t)aCount : 0,
+                              memory_order_relaxed);
+    }
+    else
+    {
+        aCount = atomic_load_explicit((_Atomic uint16_t *)aSlotPtr, memory_order_relaxed) + iAmount;
+        atomic_store_explicit((_Atomic uint16_t *)aSlotPtr,
+                              (aCount < aCounterPtr->mThreshold) ? (uint16_t)aCount : 0,
+                              memory_order_relaxed);
+    }
+    if (aCount >= aCounterPtr->mThreshold)
+    {
+        atomic_fetch_add_explicit(&aCounterPtr->mGlobal, aCount, memory_order_release);
+    }
+}
+
+/**
+ * @brief Get approximate counter value (global count only).
+ *
+ * @param ioInstancePtr Counter to read from.
+ * @param oCount Address to write count to.
+ */
+static void CompactCounter_get(tCounter_instance *ioInstancePtr,
+                               uint32_t *oCount)
+{
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    *oCount = atomic_load_explicit(&((tCompactCounter_instance *)ioInstancePtr)->mGlobal, memory_order_acquire);
+}
+
+const tCounter_interface gCompactCounter_interface =
+    {
+        CompactCounter_create,
+        CompactCounter_destroy,
+        CompactCounter_reset,
+        CompactCounter_flush,
+        CompactCounter_increment,
+        CompactCounter_get};
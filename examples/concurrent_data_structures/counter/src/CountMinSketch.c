@@ -0,0 +1,170 @@
+#include <CountMinSketch.h>
+#include <assert.h>
+#include <counter_platform.h>
+#include <memory.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+struct __tCountMinSketch
+{
+    uint32_t mThreads;          // number of threads
+    uint32_t mDepth;            // rows
+    uint32_t mWidth;            // counters per row (power of two)
+    uint32_t mShards;           // tables: mThreads when sharded, else 1
+    tCountMinSketch_mode mMode; // sharing mode
+    size_t mTableStride;        // counters between tables (whole cache lines)
+    _Atomic uint32_t *mTables;  // mShards tables of mDepth x mWidth counters
+};
+
+/**
+ * @brief Column of a key in a row. Rows use h1 + row * h2 (double hashing);
+ *        h2 is odd so rows never collapse onto the same column sequence.
+ */
+static inline uint32_t CountMinSketch_column(const tCountMinSketch *iSketchPtr,
+                                             const uint64_t iHash,
+                                             const uint32_t iRow)
+{
+    return ((uint32_t)iHash + iRow * ((uint32_t)(iHash >> 32) | 1u)) & (iSketchPtr->mWidth - 1);
+}
+
+tCountMinSketch *CountMinSketch_create(const tCountMinSketch_options *iOptionsPtr)
+{
+    tCountMinSketch *aSketchPtr;
+
+    assert(iOptionsPtr != NULL);   // required parameter
+    assert(iOptionsPtr->mThreads); // need at least one writer
+    assert(iOptionsPtr->mDepth);   // need at least one row
+    assert(iOptionsPtr->mWidth);   // need at least one column
+
+    aSketchPtr = malloc(sizeof(tCountMinSketch));
+    assert(aSketchPtr != NULL);
+    memset(aSketchPtr, 0, sizeof(tCountMinSketch)); // blank slate
+
+    aSketchPtr->mThreads = iOptionsPtr->mThreads;
+    aSketchPtr->mDepth = iOptionsPtr->mDepth;
+    aSketchPtr->mMode = iOptionsPtr->mMode;
+    aSketchPtr->mWidth = 1;
+    while (aSketchPtr->mWidth < iOptionsPtr->mWidth)
+    {
+        aSketchPtr->mWidth <<= 1;
+    }
+    aSketchPtr->mShards = (aSketchPtr->mMode == kCountMinSketch_modeSharded) ? aSketchPtr->mThreads : 1;
+
+    aSketchPtr->mTableStride = Counter_cacheLineRound((size_t)aSketchPtr->mDepth * aSketchPtr->mWidth * sizeof(uint32_t));
+    aSketchPtr->mTables = aligned_alloc(kCounter_cacheLineSize, aSketchPtr->mShards * aSketchPtr->mTableStride);
+    assert(aSketchPtr->mTables != NULL);
+    aSketchPtr->mTableStride /= sizeof(uint32_t);
+
+    CountMinSketch_reset(aSketchPtr);
+
+    return aSketchPtr;
+}
+
+void CountMinSketch_destroy(tCountMinSketch *ioSketchPtr)
+{
+    if (ioSketchPtr == NULL)
+    {
+        return;
+    }
+
+    free(ioSketchPtr->mTables);
+    free(ioSketchPtr);
+}
+
+void CountMinSketch_reset(tCountMinSketch *ioSketchPtr)
+{
+    size_t aCounter;
+
+    if (ioSketchPtr == NULL)
+    {
+        return;
+    }
+
+    for (aCounter = 0; aCounter < ioSketchPtr->mShards * ioSketchPtr->mTableStride; ++aCounter)
+    {
+        atomic_store_explicit(&ioSketchPtr->mTables[aCounter], 0, memory_order_relaxed);
+    }
+}
+
+void CountMinSketch_flush(tCountMinSketch *ioSketchPtr, const uint32_t iThread)
+{
+    (void)ioSketchPtr;
+    (void)iThread;
+}
+
+void CountMinSketch_add(tCountMinSketch *ioSketchPtr, const uint32_t iThread, const uint64_t iKey, const uint32_t iAmount)
+{
+    uint32_t aRow;
+    uint64_t aHash;
+    _Atomic uint32_t *aRowPtr;
+    _Atomic uint32_t *aCount;
+
+    assert(iThread < ioSketchPtr->mThreads);
+
+    aHash = Counter_hash64(iKey);
+
+    if (ioSketchPtr->mMode == kCountMinSketch_modeSharded)
+    {
+        aRowPtr = &ioSketchPtr->mTables[iThread * ioSketchPtr->mTableStride];
+        for (aRow = 0; aRow < ioSketchPtr->mDepth; ++aRow, aRowPtr += ioSketchPtr->mWidth)
+        {
+            aCount = &aRowPtr[CountMinSketch_column(ioSketchPtr, aHash, aRow)];
+            atomic_store_explicit(aCount, atomic_load_explicit(aCount, memory_order_relaxed) + iAmount,
+                                  memory_order_relaxed);
+        }
+    }
+    else
+    {
+        aRowPtr = ioSketchPtr->mTables;
+        for (aRow = 0; aRow < ioSketchPtr->mDepth; ++aRow, aRowPtr += ioSketchPtr->mWidth)
+        {
+            atomic_fetch_add_explicit(&aRowPtr[CountMinSketch_column(ioSketchPtr, aHash, aRow)], iAmount,
+                                      memory_order_relaxed);
+        }
+    }
+}
+
+uint64_t CountMinSketch_estimate(tCountMinSketch *ioSketchPtr, const uint64_t iKey)
+{
+    uint32_t aRow;
+    uint32_t aShard;
+    uint32_t aColumn;
+    uint64_t aHash;
+    uint64_t aCount;
+    uint64_t aMin;
+
+    aHash = Counter_hash64(iKey);
+
+    aMin = UINT64_MAX;
+    for (aRow = 0; aRow < ioSketchPtr->mDepth; ++aRow)
+    {
+        aColumn = aRow * ioSketchPtr->mWidth + CountMinSketch_column(ioSketchPtr, aHash, aRow);
+        aCount = 0;
+        for (aShard = 0; aShard < ioSketchPtr->mShards; ++aShard)
+        {
+            aCount += atomic_load_explicit(&ioSketchPtr->mTables[aShard * ioSketchPtr->mTableStride + aColumn],
+                                           memory_order_relaxed);
+        }
+        aMin = (aCount < aMin) ? aCount : aMin;
+    }
+    return aMin;
+}
+
+uint64_t CountMinSketch_total(tCountMinSketch *ioSketchPtr)
+{
+    uint32_t aShard;
+    uint32_t aColumn;
+    uint64_t aTotal;
+
+    aTotal = 0;
+    for (aShard = 0; aShard < ioSketchPtr->mShards; ++aShard)
+    {
+        for (aColumn = 0; aColumn < ioSketchPtr->mWidth; ++aColumn)
+        {
+            aTotal += atomic_load_explicit(&ioSketchPtr->mTables[aShard * ioSketchPtr->mTableStride + aColumn],
+                                           memory_order_relaxed);
+        }
+    }
+    return aTotal;
+}
@@ -0,0 +1,364 @@
+#include <CounterMap.h>
+#include <assert.h>
+#include <counter_platform.h>
+#include <memory.h>
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @brief A key and its count. Published once at the head of its chain and
+ *        never moved or freed before reset.
+ */
+typedef struct __tCounterMap_entry
+{
+    struct __tCounterMap_entry *_Atomic mNext; // next entry in the bucket chain
+    uint64_t mHash;                            // full hash of the key
+    _Atomic uint64_t mCount;                   // flushed count
+    size_t mKeyLength;                         // key length in bytes
+    unsigned char mKey[];                      // key bytes
+} tCounterMap_entry;
+
+/**
+ * @brief A cached hot key of one thread.
+ */
+typedef struct
+{
+    tCounterMap_entry *mEntryPtr; // cached key (NULL: empty)
+    uint32_t mDelta;              // amount not yet flushed to mEntryPtr->mCount
+} tCounterMap_slot;
+
+/**
+ * @brief Per-thread cache of hot keys, starting on its own cache line.
+ */
+typedef struct
+{
+    alignas(kCounter_cacheLineSize) tCounterMap_slot *mSlots; // direct-mapped by hash
+} tCounterMap_cache;
+
+/**
+ * @brief Insert lock of a stripe, one cache line each.
+ */
+typedef struct
+{
+    alignas(kCounter_cacheLineSize) pthread_mutex_t mLock; // serializes inserts into the stripe's buckets
+} tCounterMap_stripe;
+
+struct __tCounterMap
+{
+    uint32_t mThreads;                       // number of caches
+    uint32_t mBucketMask;                    // buckets - 1
+    uint32_t mStripes;                       // number of insert locks
+    uint32_t mCacheMask;                     // cache slots - 1
+    uint32_t mThreshold;                     // delta flush threshold
+    tCounterMap_entry *_Atomic *mBucketsPtr; // chain heads
+    tCounterMap_stripe *mStripesPtr;         // insert locks
+    tCounterMap_cache *mCachesPtr;           // per-thread hot-key caches
+};
+
+/**
+ * @brief FNV-1a over the key, finished with Counter_hash64 so that both
+ *        the low bits (bucket, cache slot) and the rest are spread.
+ */
+static uint64_t CounterMap_hash(const void *iKeyPtr, const size_t iKeyLength)
+{
+    size_t aByte;
+    uint64_t aHash;
+
+    aHash = 0xcbf29ce484222325ull;
+    for (aByte = 0; aByte < iKeyLength; ++aByte)
+    {
+        aHash = (aHash ^ ((const unsigned char *)iKeyPtr)[aByte]) * 0x100000001b3ull;
+    }
+    return Counter_hash64(aHash);
+}
+
+/**
+ * @brief Whether an entry holds the given key.
+ */
+static inline int CounterMap_matches(const tCounterMap_entry *iEntryPtr,
+                                     const uint64_t iHash,
+                                     const void *iKeyPtr,
+                                     const size_t iKeyLength)
+{
+    return iEntryPtr->mHash == iHash && iEntryPtr->mKeyLength == iKeyLength &&
+           memcmp(iEntryPtr->mKey, iKeyPtr, iKeyLength) == 0;
+}
+
+/**
+ * @brief Walk a chain without locks, from the given head.
+ *
+ * @return The key's entry, or NULL.
+ */
+static tCounterMap_entry *CounterMap_find(tCounterMap_entry *iHeadPtr,
+                                          const uint64_t iHash,
+                                          const void *iKeyPtr,
+                                          const size_t iKeyLength)
+{
+    tCounterMap_entry *aEntryPtr;
+
+    for (aEntryPtr = iHeadPtr; aEntryPtr != NULL;
+         aEntryPtr = atomic_load_explicit(&aEntryPtr->mNext, memory_order_acquire))
+    {
+        if (CounterMap_matches(aEntryPtr, iHash, iKeyPtr, iKeyLength))
+        {
+            return aEntryPtr;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Find a key's entry, inserting it under its stripe lock if missing.
+ *
+ * @return The key's entry.
+ */
+static tCounterMap_entry *CounterMap_findOrInsert(tCounterMap *ioMapPtr,
+                                                  const uint64_t iHash,
+                                                  const void *iKeyPtr,
+                                                  const size_t iKeyLength)
+{
+    uint32_t aBucket;
+    pthread_mutex_t *aLockPtr;
+    tCounterMap_entry *aHeadPtr;
+    tCounterMap_entry *aEntryPtr;
+
+    aBucket = (uint32_t)iHash & ioMapPtr->mBucketMask;
+    aHeadPtr = atomic_load_explicit(&ioMapPtr->mBucketsPtr[aBucket], memory_order_acquire);
+    aEntryPtr = CounterMap_find(aHeadPtr, iHash, iKeyPtr, iKeyLength);
+    if (aEntryPtr != NULL)
+    {
+        return aEntryPtr;
+    }
+
+    aLockPtr = &ioMapPtr->mStripesPtr[aBucket % ioMapPtr->mStripes].mLock;
+    pthread_mutex_lock(aLockPtr);
+
+    // only entries pushed since our walk need checking again
+    aEntryPtr = atomic_load_explicit(&ioMapPtr->mBucketsPtr[aBucket], memory_order_acquire);
+    for (; aEntryPtr != aHeadPtr; aEntryPtr = atomic_load_explicit(&aEntryPtr->mNext, memory_order_relaxed))
+    {
+        if (CounterMap_matches(aEntryPtr, iHash, iKeyPtr, iKeyLength))
+        {
+            pthread_mutex_unlock(aLockPtr);
+            return aEntryPtr;
+        }
+    }
+
+    aEntryPtr = malloc(sizeof(tCounterMap_entry) + iKeyLength);
+    assert(aEntryPtr != NULL);
+    aEntryPtr->mHash = iHash;
+    aEntryPtr->mKeyLength = iKeyLength;
+    memcpy(aEntryPtr->mKey, iKeyPtr, iKeyLength);
+    atomic_init(&aEntryPtr->mCount, 0);
+    atomic_init(&aEntryPtr->mNext, atomic_load_explicit(&ioMapPtr->mBucketsPtr[aBucket], memory_order_relaxed));
+    atomic_store_explicit(&ioMapPtr->mBucketsPtr[aBucket], aEntryPtr, memory_order_release);
+
+    pthread_mutex_unlock(aLockPtr);
+    return aEntryPtr;
+}
+
+tCounterMap *CounterMap_create(const tCounterMap_options *iOptionsPtr)
+{
+    uint32_t aStatusCode;
+    uint32_t aBuckets;
+    uint32_t aSlots;
+    uint32_t aIndex;
+    tCounterMap *aMapPtr;
+
+    assert(iOptionsPtr != NULL);   // required parameter
+    assert(iOptionsPtr->mThreads); // need at least one cache
+
+    aMapPtr = malloc(sizeof(tCounterMap));
+    assert(aMapPtr != NULL);
+    memset(aMapPtr, 0, sizeof(tCounterMap)); // blank slate
+
+    aMapPtr->mThreads = iOptionsPtr->mThreads;
+    aMapPtr->mStripes = (iOptionsPtr->mStripes != 0) ? iOptionsPtr->mStripes : 64;
+    aMapPtr->mThreshold = (iOptionsPtr->mThreshold != 0) ? iOptionsPtr->mThreshold : 1;
+    aBuckets = 1;
+    while (aBuckets < ((iOptionsPtr->mBuckets != 0) ? iOptionsPtr->mBuckets : 65536))
+    {
+        aBuckets <<= 1;
+    }
+    aSlots = 1;
+    while (aSlots < ((iOptionsPtr->mCacheSlots != 0) ? iOptionsPtr->mCacheSlots : 64))
+    {
+        aSlots <<= 1;
+    }
+    aMapPtr->mBucketMask = aBuckets - 1;
+    aMapPtr->mCacheMask = aSlots - 1;
+
+    aMapPtr->mBucketsPtr = malloc(aBuckets * sizeof(*aMapPtr->mBucketsPtr));
+    assert(aMapPtr->mBucketsPtr != NULL);
+    for (aIndex = 0; aIndex < aBuckets; ++aIndex)
+    {
+        atomic_init(&aMapPtr->mBucketsPtr[aIndex], NULL);
+    }
+
+    aMapPtr->mStripesPtr = aligned_alloc(kCounter_cacheLineSize, aMapPtr->mStripes * sizeof(tCounterMap_stripe));
+    assert(aMapPtr->mStripesPtr != NULL);
+    for (aIndex = 0; aIndex < aMapPtr->mStripes; ++aIndex)
+    {
+        aStatusCode = pthread_mutex_init(&aMapPtr->mStripesPtr[aIndex].mLock, NULL);
+        assert(aStatusCode == 0);
+    }
+
+    aMapPtr->mCachesPtr = aligned_alloc(kCounter_cacheLineSize, aMapPtr->mThreads * sizeof(tCounterMap_cache));
+    assert(aMapPtr->mCachesPtr != NULL);
+    for (aIndex = 0; aIndex < aMapPtr->mThreads; ++aIndex)
+    {
+        aMapPtr->mCachesPtr[aIndex].mSlots = aligned_alloc(kCounter_cacheLineSize,
+                                                           Counter_cacheLineRound(aSlots * sizeof(tCounterMap_slot)));
+        assert(aMapPtr->mCachesPtr[aIndex].mSlots != NULL);
+        memset(aMapPtr->mCachesPtr[aIndex].mSlots, 0, aSlots * sizeof(tCounterMap_slot));
+    }
+
+    return aMapPtr;
+}
+
+void CounterMap_destroy(tCounterMap *ioMapPtr)
+{
+    uint32_t aIndex;
+
+    if (ioMapPtr == NULL)
+    {
+        return;
+    }
+
+    CounterMap_reset(ioMapPtr); // frees the entries
+    for (aIndex = 0; aIndex < ioMapPtr->mThreads; ++aIndex)
+    {
+        free(ioMapPtr->mCachesPtr[aIndex].mSlots);
+    }
+    for (aIndex = 0; aIndex < ioMapPtr->mStripes; ++aIndex)
+    {
+        pthread_mutex_destroy(&ioMapPtr->mStripesPtr[aIndex].mLock);
+    }
+    free(ioMapPtr->mCachesPtr);
+    free(ioMapPtr->mStripesPtr);
+    free(ioMapPtr->mBucketsPtr);
+    free(ioMapPtr);
+}
+
+void CounterMap_reset(tCounterMap *ioMapPtr)
+{
+    uint32_t aIndex;
+    tCounterMap_entry *aEntryPtr;
+    tCounterMap_entry *aNextPtr;
+
+    if (ioMapPtr == NULL)
+    {
+        return;
+    }
+
+    for (aIndex = 0; aIndex < ioMapPtr->mThreads; ++aIndex)
+    {
+        memset(ioMapPtr->mCachesPtr[aIndex].mSlots, 0, (ioMapPtr->mCacheMask + 1) * sizeof(tCounterMap_slot));
+    }
+    for (aIndex = 0; aIndex <= ioMapPtr->mBucketMask; ++aIndex)
+    {
+        aEntryPtr = atomic_load_explicit(&ioMapPtr->mBucketsPtr[aIndex], memory_order_relaxed);
+        while (aEntryPtr != NULL)
+        {
+            aNextPtr = atomic_load_explicit(&aEntryPtr->mNext, memory_order_relaxed);
+            free(aEntryPtr);
+            aEntryPtr = aNextPtr;
+        }
+        atomic_store_explicit(&ioMapPtr->mBucketsPtr[aIndex], NULL, memory_order_relaxed);
+    }
+}
+
+void CounterMap_flush(tCounterMap *ioMapPtr, const uint32_t iThread)
+{
+    uint32_t aSlot;
+    tCounterMap_slot *aSlotPtr;
+
+    if (ioMapPtr == NULL)
+    {
+        return;
+    }
+
+    assert(iThread < ioMapPtr->mThreads);
+
+    for (aSlot = 0; aSlot <= ioMapPtr->mCacheMask; ++aSlot)
+    {
+        aSlotPtr = &ioMapPtr->mCachesPtr[iThread].mSlots[aSlot];
+        if (aSlotPtr->mDelta != 0)
+        {
+            atomic_fetch_add_explicit(&aSlotPtr->mEntryPtr->mCount, aSlotPtr->mDelta, memory_order_relaxed);
+            aSlotPtr->mDelta = 0;
+        }
+    }
+}
+
+void CounterMap_add(tCounterMap *ioMapPtr,
+                    const uint32_t iThread,
+                    const void *iKeyPtr,
+                    const size_t iKeyLength,
+                    const uint32_t iAmount)
+{
+    uint64_t aHash;
+    uint64_t aDelta;
+    tCounterMap_slot *aSlotPtr;
+
+    assert(iThread < ioMapPtr->mThreads);
+
+    aHash = CounterMap_hash(iKeyPtr, iKeyLength);
+    aSlotPtr = &ioMapPtr->mCachesPtr[iThread].mSlots[(aHash >> 32) & ioMapPtr->mCacheMask];
+
+    if (aSlotPtr->mEntryPtr == NULL || !CounterMap_matches(aSlotPtr->mEntryPtr, aHash, iKeyPtr, iKeyLength))
+    {
+        // cache miss: flush the key being evicted and cache this one
+        if (aSlotPtr->mDelta != 0)
+        {
+            atomic_fetch_add_explicit(&aSlotPtr->mEntryPtr->mCount, aSlotPtr->mDelta, memory_order_relaxed);
+        }
+        aSlotPtr->mEntryPtr = CounterMap_findOrInsert(ioMapPtr, aHash, iKeyPtr, iKeyLength);
+        aSlotPtr->mDelta = 0;
+    }
+
+    aDelta = (uint64_t)aSlotPtr->mDelta + iAmount;
+    if (aDelta >= ioMapPtr->mThreshold)
+    {
+        atomic_fetch_add_explicit(&aSlotPtr->mEntryPtr->mCount, aDelta, memory_order_relaxed);
+        aSlotPtr->mDelta = 0;
+    }
+    else
+    {
+        aSlotPtr->mDelta = (uint32_t)aDelta;
+    }
+}
+
+uint64_t CounterMap_get(tCounterMap *ioMapPtr, const void *iKeyPtr, const size_t iKeyLength)
+{
+    uint64_t aHash;
+    tCounterMap_entry *aEntryPtr;
+
+    aHash = CounterMap_hash(iKeyPtr, iKeyLength);
+    aEntryPtr = CounterMap_find(atomic_load_explicit(&ioMapPtr->mBucketsPtr[(uint32_t)aHash & ioMapPtr->mBucketMask],
+                                                     memory_order_acquire),
+                                aHash, iKeyPtr, iKeyLength);
+
+    return (aEntryPtr != NULL) ? atomic_load_explicit(&aEntryPtr->mCount, memory_order_relaxed) : 0;
+}
+
+void CounterMap_forEach(tCounterMap *ioMapPtr, tCounterMap_visit *iVisitPtr, void *ioContextPtr)
+{
+    uint32_t aBucket;
+    tCounterMap_entry *aEntryPtr;
+
+    for (aBucket = 0; aBucket <= ioMapPtr->mBucketMask; ++aBucket)
+    {
+        for (aEntryPtr = atomic_load_explicit(&ioMapPtr->mBucketsPtr[aBucket], memory_order_acquire);
+             aEntryPtr != NULL;
+             aEntryPtr = atomic_load_explicit(&aEntryPtr->mNext, memory_order_acquire))
+        {
+            iVisitPtr(aEntryPtr->mKey, aEntryPtr->mKeyLength,
+                      atomic_load_explicit(&aEntryPtr->mCount, memory_order_relaxed), ioContextPtr);
+        }
+    }
+}
@@ -0,0 +1,129 @@
+#include <CounterVector.h>
+#include <assert.h>
+#include <counter_platform.h>
+#include <memory.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+struct __tCounterVector
+{
+    uint32_t mThreads;       // number of rows
+    uint32_t mCounters;      // counters per row
+    size_t mRowStride;       // counts between rows (whole cache lines)
+    _Atomic uint64_t *mRows; // per-thread rows, only written by their owner
+};
+
+/**
+ * @brief Address of a thread's row.
+ */
+static inline _Atomic uint64_t *CounterVector_row(const tCounterVector *iVectorPtr, const uint32_t iThread)
+{
+    return &iVectorPtr->mRows[iThread * iVectorPtr->mRowStride];
+}
+
+tCounterVector *CounterVector_create(const tCounterVector_options *iOptionsPtr)
+{
+    size_t aRowBytes;
+    tCounterVector *aVectorPtr;
+
+    assert(iOptionsPtr != NULL);    // required parameter
+    assert(iOptionsPtr->mThreads);  // need at least one row
+    assert(iOptionsPtr->mCounters); // need at least one counter
+
+    aVectorPtr = malloc(sizeof(tCounterVector));
+    assert(aVectorPtr != NULL);
+    memset(aVectorPtr, 0, sizeof(tCounterVector)); // blank slate
+
+    aVectorPtr->mThreads = iOptionsPtr->mThreads;
+    aVectorPtr->mCounters = iOptionsPtr->mCounters;
+
+    aRowBytes = Counter_cacheLineRound(aVectorPtr->mCounters * sizeof(uint64_t));
+    aVectorPtr->mRowStride = aRowBytes / sizeof(uint64_t);
+    aVectorPtr->mRows = aligned_alloc(kCounter_cacheLineSize, aVectorPtr->mThreads * aRowBytes);
+    assert(aVectorPtr->mRows != NULL);
+
+    CounterVector_reset(aVectorPtr);
+
+    return aVectorPtr;
+}
+
+void CounterVector_destroy(tCounterVector *ioVectorPtr)
+{
+    if (ioVectorPtr == NULL)
+    {
+        return;
+    }
+
+    free(ioVectorPtr->mRows);
+    free(ioVectorPtr);
+}
+
+void CounterVector_reset(tCounterVector *ioVectorPtr)
+{
+    size_t aCount;
+
+    if (ioVectorPtr == NULL)
+    {
+        return;
+    }
+
+    for (aCount = 0; aCount < ioVectorPtr->mThreads * ioVectorPtr->mRowStride; ++aCount)
+    {
+        atomic_store_explicit(&ioVectorPtr->mRows[aCount], 0, memory_order_relaxed);
+    }
+}
+
+void CounterVector_flush(tCounterVector *ioVectorPtr, const uint32_t iThread)
+{
+    (void)ioVectorPtr;
+    (void)iThread;
+}
+
+void CounterVector_add(tCounterVector *ioVectorPtr,
+                       const uint32_t iThread,
+                       const uint32_t iCounter,
+                       const uint32_t iAmount)
+{
+    _Atomic uint64_t *aCount;
+
+    assert(iThread < ioVectorPtr->mThreads);
+    assert(iCounter < ioVectorPtr->mCounters);
+
+    aCount = &CounterVector_row(ioVectorPtr, iThread)[iCounter];
+
+    atomic_store_explicit(aCount, atomic_load_explicit(aCount, memory_order_relaxed) + iAmount, memory_order_relaxed);
+}
+
+void CounterVector_get(tCounterVector *ioVectorPtr, const uint32_t iCounter, uint64_t *oCount)
+{
+    uint32_t aThread;
+    uint64_t aCount;
+
+    assert(iCounter < ioVectorPtr->mCounters);
+
+    aCount = 0;
+    for (aThread = 0; aThread < ioVectorPtr->mThreads; ++aThread)
+    {
+        aCount += atomic_load_explicit(&CounterVector_row(ioVectorPtr, aThread)[iCounter], memory_order_relaxed);
+    }
+    *oCount = aCount;
+}
+
+void CounterVector_getAll(tCounterVector *ioVectorPtr, uint64_t *oCounts)
+{
+    uint32_t aThread;
+    uint32_t aCounter;
+    _Atomic uint64_t *aRow;
+
+    // row by row, so each thread's lines are read once and in order
+    memset(oCounts, 0, ioVectorPtr->mCounters * sizeof(uint64_t));
+    for (aThread = 0; aThread < ioVectorPtr->mThreads; ++aThread)
+    {
+        aRow = CounterVector_row(ioVectorPtr, aThread);
+        for (aCounter = 0; aCounter < ioVectorPtr->mCounters; ++aCounter)
+        {
+            oCounts[aCounter] += atomic_load_explicit(&aRow[aCounter], memory_order_relaxed);
+        }
+    }
+}
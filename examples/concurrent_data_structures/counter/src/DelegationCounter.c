@@ -0,0 +1,323 @@
+#include <DelegationCounter.h>
+#include <assert.h>
+#include <counter_platform.h>
+#include <memory.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define kDelegationCounter_idleSweeps 64      // idle sweeps spent yielding before the server starts sleeping
+#define kDelegationCounter_maxSleepNs 1000000 // longest idle sleep, bounds flush/reset/destroy latency once idle
+
+/**
+ * @brief Per-client request line. Only the client writes it.
+ *
+ * mPosted is the running total of everything the client has posted; the
+ * server applies the difference to what it saw on its previous sweep, so a
+ * post is a plain store and never waits for the server.
+ */
+typedef struct
+{
+    alignas(kCounter_cacheLineSize) _Atomic uint32_t mPosted; // running total posted
+} tDelegationCounter_mailbox;
+
+/**
+ * @brief Delegation counter with a dedicated server thread.
+ *
+ * The server sweeps the client mailboxes and is the only writer of the count,
+ * which therefore never leaves the server's core. Its results are published
+ * in mPublished (read by get) and, per client, in mApplied (read by flush).
+ */
+typedef struct
+{
+    tCounter_instance mBase;              // base class (must be first field)
+    uint32_t mThreads;                    // number of client threads
+    tDelegationCounter_mailbox *mMailbox; // request lines (one per client)
+    uint32_t *mSeen;                      // server-private: mPosted at last sweep
+    _Atomic uint32_t *mApplied;           // server-written: client totals applied
+    pthread_t mServer;                    // server thread
+
+    alignas(kCounter_cacheLineSize) _Atomic uint32_t mPublished; // count published by the server
+    _Atomic uint32_t mResetRequest;                              // reset generation requested
+    _Atomic uint32_t mResetDone;                                 // reset generation served
+    _Atomic bool mStop;                                          // server shutdown request
+} tDelegationCounter_instance;
+
+/**
+ * @brief Server thread. Sweeps the mailboxes and applies new posts in batches
+ *        until asked to stop.
+ *
+ * @param ioCounterPtr The tDelegationCounter_instance to serve.
+ */
+static void *DelegationCounter_server(void *ioCounterPtr)
+{
+    bool aIdle;
+    uint32_t aIdleSweeps;
+    uint32_t aCount;
+    uint32_t aClient;
+    uint32_t aPosted;
+    uint32_t aReset;
+    struct timespec aSleep;
+    tDelegationCounter_instance *aCounterPtr;
+
+    aCounterPtr = (tDelegationCounter_instance *)ioCounterPtr;
+    aCount = 0;
+    aIdleSweeps = 0;
+    aSleep.tv_sec = 0;
+
+    while (!atomic_load_explicit(&aCounterPtr->mStop, memory_order_acquire))
+    {
+        aIdle = true;
+        for (aClient = 0; aClient < aCounterPtr->mThreads; ++aClient)
+        {
+            aPosted = atomic_load_explicit(&aCounterPtr->mMailbox[aClient].mPosted, memory_order_acquire);
+            if (aPosted != aCounterPtr->mSeen[aClient])
+            {
+                aCount += aPosted - aCounterPtr->mSeen[aClient]; // modular, survives wrap-around
+                aCounterPtr->mSeen[aClient] = aPosted;
+                aIdle = false;
+            }
+        }
+
+        // posts swept before a reset request are discarded by it
+        aReset = atomic_load_explicit(&aCounterPtr->mResetRequest, memory_order_acquire);
+        if (aReset != atomic_load_explicit(&aCounterPtr->mResetDone, memory_order_relaxed))
+        {
+            aCount = 0;
+            aIdle = false;
+        }
+
+        if (aIdle)
+        {
+            // nothing to do: give the core to the clients, then back off
+            // exponentially so an unused counter does not burn a core
+            if (aIdleSweeps < kDelegationCounter_idleSweeps)
+            {
+                ++aIdleSweeps;
+                aSleep.tv_nsec = 1000;
+                sched_yield();
+            }
+            else
+            {
+                nanosleep(&aSleep, NULL);
+                aSleep.tv_nsec = (aSleep.tv_nsec < kDelegationCounter_maxSleepNs / 2) ? aSleep.tv_nsec * 2
+                                                                                     : kDelegationCounter_maxSleepNs;
+            }
+            continue;
+        }
+        aIdleSweeps = 0;
+        atomic_store_explicit(&aCounterPtr->mPublished, aCount, memory_order_release);
+
+        // acknowledge only once published, so a flushed client's get sees its posts
+        for (aClient = 0; aClient < aCounterPtr->mThreads; ++aClient)
+        {
+            if (atomic_load_explicit(&aCounterPtr->mApplied[aClient], memory_order_relaxed) != aCounterPtr->mSeen[aClient])
+            {
+                atomic_store_explicit(&aCounterPtr->mApplied[aClient], aCounterPtr->mSeen[aClient], memory_order_release);
+            }
+        }
+        atomic_store_explicit(&aCounterPtr->mResetDone, aReset, memory_order_release);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Allocate and initialize the delegation counter and start its server.
+ *
+ * @param iBasePtr Counter base to initialize.
+ * @param iOptionsPtr Pointer to tDelegationCounter_options, or NULL for defaults.
+ * @return Pointer to new counter instance.
+ */
+static tCounter_instance *DelegationCounter_create(const tCounter_instance *iBasePtr, const void *iOptionsPtr)
+{
+    uint32_t aStatusCode;
+    uint32_t aClient;
+    uint32_t aThreads;
+    tDelegationCounter_instance *aCounterPtr;
+
+    assert(iBasePtr != NULL); // required parameter
+
+    // get options
+    if (iOptionsPtr != NULL)
+    {
+        aThreads = ((const tDelegationCounter_options *)iOptionsPtr)->mThreads;
+    }
+    else
+    {
+        // use defaults
+        aThreads = 8;
+    }
+
+    // allocate delegation counter instance
+    aCounterPtr = aligned_alloc(kCounter_cacheLineSize, sizeof(tDelegationCounter_instance));
+    assert(aCounterPtr != NULL);
+    memset(aCounterPtr, 0, sizeof(tDelegationCounter_instance)); // blank slate
+
+    // copy the base into the instance
+    memcpy(aCounterPtr, iBasePtr, sizeof(tCounter_instance));
+
+    // initialize counter shallow state
+    aCounterPtr->mThreads = aThreads;
+    atomic_init(&aCounterPtr->mPublished, 0);
+    atomic_init(&aCounterPtr->mResetRequest, 0);
+    atomic_init(&aCounterPtr->mResetDone, 0);
+    atomic_init(&aCounterPtr->mStop, false);
+
+    // allocate counter heap state
+    aCounterPtr->mMailbox = aligned_alloc(kCounter_cacheLineSize,
+                                          aThreads * sizeof(tDelegationCounter_mailbox));
+    aCounterPtr->mSeen = malloc(aThreads * sizeof(uint32_t));
+    aCounterPtr->mApplied = malloc(aThreads * sizeof(_Atomic uint32_t));
+    assert(aCounterPtr->mMailbox != NULL && aCounterPtr->mSeen != NULL && aCounterPtr->mApplied != NULL);
+    for (aClient = 0; aClient < aThreads; ++aClient)
+    {
+        atomic_init(&aCounterPtr->mMailbox[aClient].mPosted, 0);
+        aCounterPtr->mSeen[aClient] = 0;
+        atomic_init(&aCounterPtr->mApplied[aClient], 0);
+    }
+
+    // start the server
+    aStatusCode = pthread_create(&aCounterPtr->mServer, NULL, DelegationCounter_server, aCounterPtr);
+    assert(aStatusCode == 0);
+
+    return (tCounter_instance *)aCounterPtr;
+}
+
+/**
+ * @brief Stop the server and free all memory allocated in _create.
+ *
+ * @param ioInstancePtr Counter instance to destroy.
+ */
+static void DelegationCounter_destroy(tCounter_instance *ioInstancePtr)
+{
+    tDelegationCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tDelegationCounter_instance *)ioInstancePtr;
+
+    atomic_store_explicit(&aCounterPtr->mStop, true, memory_order_release);
+    pthread_join(aCounterPtr->mServer, NULL);
+
+    free(aCounterPtr->mMailbox);
+    free(aCounterPtr->mSeen);
+    free(aCounterPtr->mApplied);
+    free(aCounterPtr);
+}
+
+/**
+ * @brief Reset counter to zero. Waits for the server to acknowledge.
+ *
+ * @param ioInstancePtr Counter to reset.
+ */
+static void DelegationCounter_reset(tCounter_instance *ioInstancePtr)
+{
+    uint32_t aReset;
+    tDelegationCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tDelegationCounter_instance *)ioInstancePtr;
+
+    aReset = atomic_fetch_add_explicit(&aCounterPtr->mResetRequest, 1, memory_order_release) + 1;
+    while (atomic_load_explicit(&aCounterPtr->mResetDone, memory_order_acquire) != aReset)
+    {
+        sched_yield();
+    }
+}
+
+/**
+ * @brief Wait until the server has applied everything the thread posted.
+ *
+ * @param ioInstancePtr Counter instance.
+ * @param iThread Thread ID to flush.
+ */
+static void DelegationCounter_flush(tCounter_instance *ioInstancePtr,
+                                    const uint32_t iThread)
+{
+    uint32_t aPosted;
+    tDelegationCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tDelegationCounter_instance *)ioInstancePtr;
+
+    aPosted = atomic_load_explicit(&aCounterPtr->mMailbox[iThread].mPosted, memory_order_relaxed);
+    while (atomic_load_explicit(&aCounterPtr->mApplied[iThread], memory_order_acquire) != aPosted)
+    {
+        sched_yield();
+    }
+}
+
+/**
+ * @brief Post an increment to the caller's mailbox.
+ *
+ * @param ioInstancePtr Counter to update.
+ * @param iThread Thread ID (0 to num_threads-1) of the caller.
+ * @param iAmount Amount to add to counter.
+ */
+static void DelegationCounter_increment(tCounter_instance *ioInstancePtr,
+                                        const uint32_t iThread,
+                                        const uint32_t iAmount)
+{
+    _Atomic uint32_t *aPosted;
+    tDelegationCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tDelegationCounter_instance *)ioInstancePtr;
+    aPosted = &aCounterPtr->mMailbox[iThread].mPosted;
+
+    // the server only reads the running total, diffing it against mSeen
+    atomic_store_explicit(aPosted,
+                          atomic_load_explicit(aPosted, memory_order_relaxed) + iAmount,
+                          memory_order_release);
+}
+
+/**
+ * @brief Get the count last published by the server.
+ *
+ * @param ioInstancePtr Counter to read from.
+ * @param oCount Address to write count to.
+ */
+static void DelegationCounter_get(tCounter_instance *ioInstancePtr,
+                                  uint32_t *oCount)
+{
+    tDelegationCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tDelegationCounter_instance *)ioInstancePtr;
+
+    *oCount = atomic_load_explicit(&aCounterPtr->mPublished, memory_order_acquire);
+}
+
+const tCounter_interface gDelegationCounter_interface =
+    {
+        DelegationCounter_create,
+        DelegationCounter_destroy,
+        DelegationCounter_reset,
+        DelegationCounter_flush,
+        DelegationCounter_increment,
+        DelegationCounter_get};
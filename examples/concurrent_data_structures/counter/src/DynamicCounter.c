@@ -0,0 +1,375 @@
+#include <DynamicCounter.h>
+#include <assert.h>
+#include <counter_platform.h>
+#include <memory.h>
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+enum
+{
+    kDynamicCounter_firstSegment = 8, // Slots in segment 0; segment s holds 8 << s slots
+    kDynamicCounter_segments = 24     // Maximum number of segments
+};
+
+struct __tDynamicCounter_instance;
+
+/**
+ * @brief Per-thread slot, one cache line each. The thread's pthread key value
+ *        points at its slot.
+ */
+typedef struct
+{
+    alignas(kCounter_cacheLineSize) _Atomic uint32_t mLocal; // local count
+    uint32_t mId;                                            // slot index
+    struct __tDynamicCounter_instance *mCounterPtr;          // owning counter
+} tDynamicCounter_slot;
+
+/**
+ * @brief Sloppy counter with lazily registered, recycled thread slots.
+ *
+ * Slots live in segments of doubling size. A segment is published once and
+ * never moved or freed before destroy, so a slot pointer stays valid while
+ * the table grows. Registration and release are rare and serialized by
+ * mRegistryLock; counting never takes a lock.
+ */
+typedef struct __tDynamicCounter_instance
+{
+    tCounter_instance mBase;       // base class (must be first field)
+    uint32_t mThreshold;           // update frequency
+    pthread_key_t mKey;            // calling thread's slot
+    pthread_mutex_t mRegistryLock; // protects slot allocation
+    uint32_t mUsed;                // slot ids handed out so far (high-water mark)
+    uint32_t *mFree;               // released slot ids
+    uint32_t mFreeCount;           // number of entries in mFree
+    uint32_t mFreeCapacity;        // capacity of mFree
+
+    _Atomic(tDynamicCounter_slot *) mSegment[kDynamicCounter_segments]; // slot segments
+    _Atomic uint32_t mPublished;                                         // slot ids readers may visit
+
+    alignas(kCounter_cacheLineSize) _Atomic uint32_t mGlobal; // global count
+} tDynamicCounter_instance;
+
+/**
+ * @brief Address of slot iId.
+ */
+static tDynamicCounter_slot *DynamicCounter_slot(tDynamicCounter_instance *iCounterPtr, uint32_t iId)
+{
+    uint32_t aSegment;
+    uint32_t aBlock;
+
+    // segment s covers ids [8 * (2^s - 1), 8 * (2^(s+1) - 1))
+    aBlock = iId / kDynamicCounter_firstSegment + 1;
+    aSegment = 31 - (uint32_t)__builtin_clz(aBlock);
+
+    return &atomic_load_explicit(&iCounterPtr->mSegment[aSegment], memory_order_acquire)
+                [iId - kDynamicCounter_firstSegment * ((1u << aSegment) - 1)];
+}
+
+/**
+ * @brief Thread-exit hook: flush the slot and give it back to the counter.
+ *
+ * @param ioSlotPtr The exiting thread's tDynamicCounter_slot.
+ */
+static void DynamicCounter_release(void *ioSlotPtr)
+{
+    uint32_t aCount;
+    tDynamicCounter_slot *aSlotPtr;
+    tDynamicCounter_instance *aCounterPtr;
+
+    aSlotPtr = (tDynamicCounter_slot *)ioSlotPtr;
+    aCounterPtr = aSlotPtr->mCounterPtr;
+
+    aCount = atomic_exchange_explicit(&aSlotPtr->mLocal, 0, memory_order_relaxed);
+    if (aCount != 0)
+    {
+        atomic_fetch_add_explicit(&aCounterPtr->mGlobal, aCount, memory_order_release);
+    }
+
+    pthread_mutex_lock(&aCounterPtr->mRegistryLock);
+    if (aCounterPtr->mFreeCount == aCounterPtr->mFreeCapacity)
+    {
+        aCounterPtr->mFreeCapacity = (aCounterPtr->mFreeCapacity == 0) ? kDynamicCounter_firstSegment
+                                                                        : 2 * aCounterPtr->mFreeCapacity;
+        aCounterPtr->mFree = realloc(aCounterPtr->mFree, aCounterPtr->mFreeCapacity * sizeof(uint32_t));
+        assert(aCounterPtr->mFree != NULL);
+    }
+    aCounterPtr->mFree[aCounterPtr->mFreeCount++] = aSlotPtr->mId;
+    pthread_mutex_unlock(&aCounterPtr->mRegistryLock);
+}
+
+/**
+ * @brief Give the calling thread a slot: a released one if available, else a
+ *        new one, growing the table by a segment when full.
+ *
+ * @param ioCounterPtr Counter to register with.
+ * @return The calling thread's slot.
+ */
+static tDynamicCounter_slot *DynamicCounter_register(tDynamicCounter_instance *ioCounterPtr)
+{
+    uint32_t aId;
+    uint32_t aSegment;
+    uint32_t aSlot;
+    uint32_t aSlots;
+    uint32_t aStatusCode;
+    tDynamicCounter_slot *aSegmentPtr;
+    tDynamicCounter_slot *aSlotPtr;
+
+    pthread_mutex_lock(&ioCounterPtr->mRegistryLock);
+    if (ioCounterPtr->mFreeCount != 0)
+    {
+        aId = ioCounterPtr->mFree[--ioCounterPtr->mFreeCount];
+    }
+    else
+    {
+        aId = ioCounterPtr->mUsed++;
+        aSegment = 31 - (uint32_t)__builtin_clz(aId / kDynamicCounter_firstSegment + 1);
+        assert(aSegment < kDynamicCounter_segments);
+        if (atomic_load_explicit(&ioCounterPtr->mSegment[aSegment], memory_order_relaxed) == NULL)
+        {
+            aSlots = kDynamicCounter_firstSegment << aSegment;
+            aSegmentPtr = aligned_alloc(kCounter_cacheLineSize, aSlots * sizeof(tDynamicCounter_slot));
+            assert(aSegmentPtr != NULL);
+            for (aSlot = 0; aSlot < aSlots; ++aSlot)
+            {
+                atomic_init(&aSegmentPtr[aSlot].mLocal, 0);
+                aSegmentPtr[aSlot].mId = aId + aSlot;
+                aSegmentPtr[aSlot].mCounterPtr = ioCounterPtr;
+            }
+            atomic_store_explicit(&ioCounterPtr->mSegment[aSegment], aSegmentPtr, memory_order_release);
+        }
+        atomic_store_explicit(&ioCounterPtr->mPublished, ioCounterPtr->mUsed, memory_order_release);
+    }
+    pthread_mutex_unlock(&ioCounterPtr->mRegistryLock);
+
+    aSlotPtr = DynamicCounter_slot(ioCounterPtr, aId);
+    aStatusCode = pthread_setspecific(ioCounterPtr->mKey, aSlotPtr);
+    assert(aStatusCode == 0);
+
+    return aSlotPtr;
+}
+
+/**
+ * @brief Calling thread's slot, registering the thread on first use.
+ */
+static inline tDynamicCounter_slot *DynamicCounter_self(tDynamicCounter_instance *ioCounterPtr)
+{
+    tDynamicCounter_slot *aSlotPtr;
+
+    aSlotPtr = pthread_getspecific(ioCounterPtr->mKey);
+    if (aSlotPtr == NULL)
+    {
+        aSlotPtr = DynamicCounter_register(ioCounterPtr);
+    }
+    return aSlotPtr;
+}
+
+/**
+ * @brief Allocate and initialize the dynamic counter.
+ *
+ * @param iBasePtr Counter base to initialize.
+ * @param iOptionsPtr Pointer to tDynamicCounter_options, or NULL for defaults.
+ * @return Pointer to new counter instance.
+ */
+static tCounter_instance *DynamicCounter_create(const tCounter_instance *iBasePtr, const void *iOptionsPtr)
+{
+    uint32_t aStatusCode;
+    uint32_t aSegment;
+    tDynamicCounter_instance *aCounterPtr;
+
+    assert(iBasePtr != NULL); // required parameter
+
+    // allocate dynamic counter instance
+    aCounterPtr = aligned_alloc(kCounter_cacheLineSize, sizeof(tDynamicCounter_instance));
+    assert(aCounterPtr != NULL);
+    memset(aCounterPtr, 0, sizeof(tDynamicCounter_instance)); // blank slate
+
+    // copy the base into the instance
+    memcpy(aCounterPtr, iBasePtr, sizeof(tCounter_instance));
+
+    // get options
+    if (iOptionsPtr != NULL)
+    {
+        aCounterPtr->mThreshold = ((const tDynamicCounter_options *)iOptionsPtr)->mThreshold;
+    }
+    else
+    {
+        // use defaults
+        aCounterPtr->mThreshold = 1024;
+    }
+
+    // initialize counter state
+    atomic_init(&aCounterPtr->mGlobal, 0);
+    atomic_init(&aCounterPtr->mPublished, 0);
+    for (aSegment = 0; aSegment < kDynamicCounter_segments; ++aSegment)
+    {
+        atomic_init(&aCounterPtr->mSegment[aSegment], NULL);
+    }
+    aCounterPtr->mUsed = 0;
+    aCounterPtr->mFree = NULL;
+    aCounterPtr->mFreeCount = 0;
+    aCounterPtr->mFreeCapacity = 0;
+
+    aStatusCode = pthread_mutex_init(&aCounterPtr->mRegistryLock, NULL);
+    assert(aStatusCode == 0);
+    aStatusCode = pthread_key_create(&aCounterPtr->mKey, DynamicCounter_release);
+    assert(aStatusCode == 0);
+
+    return (tCounter_instance *)aCounterPtr;
+}
+
+/**
+ * @brief Clean up counter resources. Free all memory allocated in _create.
+ *
+ * Threads still registered lose their slot without running the exit hook.
+ *
+ * @param ioInstancePtr Counter instance to destroy.
+ */
+static void DynamicCounter_destroy(tCounter_instance *ioInstancePtr)
+{
+    uint32_t aSegment;
+    tDynamicCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tDynamicCounter_instance *)ioInstancePtr;
+
+    pthread_key_delete(aCounterPtr->mKey);
+    pthread_mutex_destroy(&aCounterPtr->mRegistryLock);
+    for (aSegment = 0; aSegment < kDynamicCounter_segments; ++aSegment)
+    {
+        free(atomic_load_explicit(&aCounterPtr->mSegment[aSegment], memory_order_relaxed));
+    }
+    free(aCounterPtr->mFree);
+    free(aCounterPtr);
+}
+
+/**
+ * @brief Reset all counts to zero. Writers must be quiescent.
+ *
+ * @param ioInstancePtr Counter to reset.
+ */
+static void DynamicCounter_reset(tCounter_instance *ioInstancePtr)
+{
+    uint32_t aId;
+    uint32_t aUsed;
+    tDynamicCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tDynamicCounter_instance *)ioInstancePtr;
+
+    aUsed = atomic_load_explicit(&aCounterPtr->mPublished, memory_order_acquire);
+    for (aId = 0; aId < aUsed; ++aId)
+    {
+        atomic_store_explicit(&DynamicCounter_slot(aCounterPtr, aId)->mLocal, 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&aCounterPtr->mGlobal, 0, memory_order_release);
+}
+
+/**
+ * @brief Flush the calling thread's local count to the global count.
+ *
+ * @param ioInstancePtr Counter instance.
+ * @param iThread Ignored (the caller's own slot is flushed).
+ */
+static void DynamicCounter_flush(tCounter_instance *ioInstancePtr,
+                                 const uint32_t iThread)
+{
+    uint32_t aCount;
+    tDynamicCounter_slot *aSlotPtr;
+    tDynamicCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tDynamicCounter_instance *)ioInstancePtr;
+
+    aSlotPtr = pthread_getspecific(aCounterPtr->mKey);
+    if (aSlotPtr == NULL)
+    {
+        return; // never counted, nothing to flush
+    }
+
+    aCount = atomic_exchange_explicit(&aSlotPtr->mLocal, 0, memory_order_relaxed);
+    if (aCount != 0)
+    {
+        atomic_fetch_add_explicit(&aCounterPtr->mGlobal, aCount, memory_order_release);
+    }
+}
+
+/**
+ * @brief Increment the calling thread's local count, flushing to global when
+ *        the threshold is reached.
+ *
+ * @param ioInstancePtr Counter to update.
+ * @param iThread Ignored (the caller's slot is looked up).
+ * @param iAmount Amount to add to local counter.
+ */
+static void DynamicCounter_increment(tCounter_instance *ioInstancePtr,
+                                     const uint32_t iThread,
+                                     const uint32_t iAmount)
+{
+    uint32_t aCount;
+    tDynamicCounter_slot *aSlotPtr;
+    tDynamicCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tDynamicCounter_instance *)ioInstancePtr;
+    aSlotPtr = DynamicCounter_self(aCounterPtr);
+
+    aCount = atomic_load_explicit(&aSlotPtr->mLocal, memory_order_relaxed) + iAmount;
+    if (aCount >= aCounterPtr->mThreshold)
+    {
+        atomic_store_explicit(&aSlotPtr->mLocal, 0, memory_order_relaxed);
+        atomic_fetch_add_explicit(&aCounterPtr->mGlobal, aCount, memory_order_release);
+    }
+    else
+    {
+        atomic_store_explicit(&aSlotPtr->mLocal, aCount, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Get approximate counter value (global count only).
+ *
+ * @param ioInstancePtr Counter to read from.
+ * @param oCount Pointer to write count to.
+ */
+static void DynamicCounter_get(tCounter_instance *ioInstancePtr,
+                               uint32_t *oCount)
+{
+    tDynamicCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tDynamicCounter_instance *)ioInstancePtr;
+
+    *oCount = atomic_load_explicit(&aCounterPtr->mGlobal, memory_order_acquire);
+}
+
+const tCounter_interface gDynamicCounter_interface =
+    {
+        DynamicCounter_create,
+        DynamicCounter_destroy,
+        DynamicCounter_reset,
+        DynamicCounter_flush,
+        DynamicCounter_increment,
+        DynamicCounter_get};
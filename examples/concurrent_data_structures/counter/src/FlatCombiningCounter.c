@@ -0,0 +1,255 @@
+#include <FlatCombiningCounter.h>
+#include <assert.h>
+#include <counter_platform.h>
+#include <memory.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @brief Per-thread publication record, one cache line each.
+ */
+typedef struct
+{
+    alignas(kCounter_cacheLineSize) _Atomic uint32_t mPending; // published amount (0: none)
+} tFlatCombiningCounter_record;
+
+/**
+ * @brief Flat-combining counter.
+ *
+ * A thread publishes its amount in its record and tries to become the
+ * combiner. The combiner applies every published amount in one pass over the
+ * records; the other threads spin on their own record until it is cleared.
+ * mGlobal is only written by the combiner, so one lock handoff serves a whole
+ * batch of increments.
+ */
+typedef struct
+{
+    tCounter_instance mBase;               // base class (must be first field)
+    uint32_t mThreads;                     // number of publishing threads
+    tFlatCombiningCounter_record *mRecord; // publication records (one per thread)
+
+    alignas(kCounter_cacheLineSize) _Atomic bool mCombining; // combiner lock
+    _Atomic uint32_t mGlobal;                                // global count
+} tFlatCombiningCounter_instance;
+
+/**
+ * @brief Allocate and initialize the flat-combining counter.
+ *
+ * @param iBasePtr Counter base to initialize.
+ * @param iOptionsPtr Pointer to tFlatCombiningCounter_options, or NULL for defaults.
+ * @return Pointer to new counter instance.
+ */
+static tCounter_instance *FlatCombiningCounter_create(const tCounter_instance *iBasePtr, const void *iOptionsPtr)
+{
+    uint32_t aThread;
+    uint32_t aThreads;
+    tFlatCombiningCounter_instance *aCounterPtr;
+
+    assert(iBasePtr != NULL); // required parameter
+
+    // get options
+    if (iOptionsPtr != NULL)
+    {
+        aThreads = ((const tFlatCombiningCounter_options *)iOptionsPtr)->mThreads;
+    }
+    else
+    {
+        // use defaults
+        aThreads = 8;
+    }
+
+    // allocate flat-combining counter instance
+    aCounterPtr = aligned_alloc(kCounter_cacheLineSize, sizeof(tFlatCombiningCounter_instance));
+    assert(aCounterPtr != NULL);
+    memset(aCounterPtr, 0, sizeof(tFlatCombiningCounter_instance)); // blank slate
+
+    // copy the base into the instance
+    memcpy(aCounterPtr, iBasePtr, sizeof(tCounter_instance));
+
+    // initialize counter state
+    aCounterPtr->mThreads = aThreads;
+    atomic_init(&aCounterPtr->mCombining, false);
+    atomic_init(&aCounterPtr->mGlobal, 0);
+
+    // allocate publication records
+    aCounterPtr->mRecord = aligned_alloc(kCounter_cacheLineSize,
+                                         aThreads * sizeof(tFlatCombiningCounter_record));
+    assert(aCounterPtr->mRecord != NULL);
+    for (aThread = 0; aThread < aThreads; ++aThread)
+    {
+        atomic_init(&aCounterPtr->mRecord[aThread].mPending, 0);
+    }
+
+    return (tCounter_instance *)aCounterPtr;
+}
+
+/**
+ * @brief Clean up counter resources. Free all memory allocated in _create.
+ *
+ * @param ioInstancePtr Counter instance to destroy.
+ */
+static void FlatCombiningCounter_destroy(tCounter_instance *ioInstancePtr)
+{
+    tFlatCombiningCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tFlatCombiningCounter_instance *)ioInstancePtr;
+
+    free(aCounterPtr->mRecord);
+    free(aCounterPtr);
+}
+
+/**
+ * @brief Try to become the combiner.
+ *
+ * @return true if the caller now holds the combiner lock.
+ */
+static inline bool FlatCombiningCounter_tryLock(tFlatCombiningCounter_instance *ioCounterPtr)
+{
+    return !atomic_load_explicit(&ioCounterPtr->mCombining, memory_order_relaxed) &&
+           !atomic_exchange_explicit(&ioCounterPtr->mCombining, true, memory_order_acquire);
+}
+
+/**
+ * @brief Release the combiner lock.
+ */
+static inline void FlatCombiningCounter_unlock(tFlatCombiningCounter_instance *ioCounterPtr)
+{
+    atomic_store_explicit(&ioCounterPtr->mCombining, false, memory_order_release);
+}
+
+/**
+ * @brief Reset counter to zero.
+ *
+ * @param ioInstancePtr Counter to reset.
+ */
+static void FlatCombiningCounter_reset(tCounter_instance *ioInstancePtr)
+{
+    tFlatCombiningCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tFlatCombiningCounter_instance *)ioInstancePtr;
+
+    while (!FlatCombiningCounter_tryLock(aCounterPtr))
+    {
+        Counter_cpuRelax();
+    }
+    atomic_store_explicit(&aCounterPtr->mGlobal, 0, memory_order_relaxed);
+    FlatCombiningCounter_unlock(aCounterPtr);
+}
+
+/**
+ * @brief Flush pending updates.
+ *
+ * No-op for flat-combining counter (increment returns once applied).
+ *
+ * @param ioInstancePtr Counter instance.
+ * @param iThread Ignored.
+ */
+static void FlatCombiningCounter_flush(tCounter_instance *ioInstancePtr, const uint32_t iThread)
+{
+    // Do nothing - increments are applied before they return
+}
+
+/**
+ * @brief Publish an increment and wait until some combiner has applied it.
+ *
+ * @param ioInstancePtr Counter to update.
+ * @param iThread Thread ID (0 to num_threads-1) of the caller.
+ * @param iAmount Amount to add to counter.
+ */
+static void FlatCombiningCounter_increment(tCounter_instance *ioInstancePtr,
+                                           const uint32_t iThread,
+                                           const uint32_t iAmount)
+{
+    uint32_t aRecord;
+    uint32_t aGlobal;
+    _Atomic uint32_t *aPending;
+    tFlatCombiningCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL || iAmount == 0)
+    {
+        return;
+    }
+
+    aCounterPtr = (tFlatCombiningCounter_instance *)ioInstancePtr;
+    aPending = &aCounterPtr->mRecord[iThread].mPending;
+
+    atomic_store_explicit(aPending, iAmount, memory_order_release);
+
+    for (;;)
+    {
+        if (FlatCombiningCounter_tryLock(aCounterPtr))
+        {
+            // combine: apply every published amount, ours included
+            aGlobal = atomic_load_explicit(&aCounterPtr->mGlobal, memory_order_relaxed);
+            for (aRecord = 0; aRecord < aCounterPtr->mThreads; ++aRecord)
+            {
+                if (atomic_load_explicit(&aCounterPtr->mRecord[aRecord].mPending, memory_order_relaxed) != 0)
+                {
+                    aGlobal += atomic_exchange_explicit(&aCounterPtr->mRecord[aRecord].mPending,
+                                                        0,
+                                                        memory_order_acquire);
+                }
+            }
+            atomic_store_explicit(&aCounterPtr->mGlobal, aGlobal, memory_order_release);
+            FlatCombiningCounter_unlock(aCounterPtr);
+            return;
+        }
+
+        // wait for the current combiner to serve us or to step down
+        while (atomic_load_explicit(&aCounterPtr->mCombining, memory_order_relaxed))
+        {
+            if (atomic_load_explicit(aPending, memory_order_acquire) == 0)
+            {
+                return;
+            }
+            Counter_cpuRelax();
+        }
+        if (atomic_load_explicit(aPending, memory_order_acquire) == 0)
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Get current counter value.
+ *
+ * @param ioInstancePtr Counter to read from.
+ * @param oCount Address to write count to.
+ */
+static void FlatCombiningCounter_get(tCounter_instance *ioInstancePtr,
+                                     uint32_t *oCount)
+{
+    tFlatCombiningCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tFlatCombiningCounter_instance *)ioInstancePtr;
+
+    *oCount = atomic_load_explicit(&aCounterPtr->mGlobal, memory_order_acquire);
+}
+
+const tCounter_interface gFlatCombiningCounter_interface =
+    {
+        FlatCombiningCounter_create,
+        FlatCombiningCounter_destroy,
+        FlatCombiningCounter_reset,
+        FlatCombiningCounter_flush,
+        FlatCombiningCounter_increment,
+        FlatCombiningCounter_get};
@@ -0,0 +1,158 @@
+#include <Gauge.h>
+#include <assert.h>
+#include <counter_platform.h>
+#include <memory.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @brief Per-thread delta, one cache line each. Only the owner writes it;
+ *        readers may load it at any time.
+ */
+typedef struct
+{
+    alignas(kCounter_cacheLineSize) _Atomic int64_t mLocal; // unflushed delta
+} tGauge_slot;
+
+struct __tGauge
+{
+    uint32_t mThreads;   // number of slots
+    uint32_t mThreshold; // flush magnitude
+    tGauge_slot *mSlots; // per-thread deltas
+
+    alignas(kCounter_cacheLineSize) _Atomic int64_t mGlobal; // global value
+};
+
+tGauge *Gauge_create(const tGauge_options *iOptionsPtr)
+{
+    tGauge *aGaugePtr;
+
+    assert(iOptionsPtr != NULL);   // required parameter
+    assert(iOptionsPtr->mThreads); // need at least one slot
+
+    aGaugePtr = aligned_alloc(kCounter_cacheLineSize, sizeof(tGauge));
+    assert(aGaugePtr != NULL);
+    memset(aGaugePtr, 0, sizeof(tGauge)); // blank slate
+
+    aGaugePtr->mThreads = iOptionsPtr->mThreads;
+    aGaugePtr->mThreshold = (iOptionsPtr->mThreshold != 0) ? iOptionsPtr->mThreshold : 1;
+
+    aGaugePtr->mSlots = aligned_alloc(kCounter_cacheLineSize, aGaugePtr->mThreads * sizeof(tGauge_slot));
+    assert(aGaugePtr->mSlots != NULL);
+
+    Gauge_reset(aGaugePtr);
+
+    return aGaugePtr;
+}
+
+void Gauge_destroy(tGauge *ioGaugePtr)
+{
+    if (ioGaugePtr == NULL)
+    {
+        return;
+    }
+
+    free(ioGaugePtr->mSlots);
+    free(ioGaugePtr);
+}
+
+void Gauge_reset(tGauge *ioGaugePtr)
+{
+    uint32_t aThread;
+
+    if (ioGaugePtr == NULL)
+    {
+        return;
+    }
+
+    for (aThread = 0; aThread < ioGaugePtr->mThreads; ++aThread)
+    {
+        atomic_store_explicit(&ioGaugePtr->mSlots[aThread].mLocal, 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&ioGaugePtr->mGlobal, 0, memory_order_release);
+}
+
+void Gauge_flush(tGauge *ioGaugePtr, const uint32_t iThread)
+{
+    int64_t aDelta;
+
+    if (ioGaugePtr == NULL)
+    {
+        return;
+    }
+
+    assert(iThread < ioGaugePtr->mThreads);
+
+    // same order as Gauge_add: global first, then clear the slot
+    aDelta = atomic_load_explicit(&ioGaugePtr->mSlots[iThread].mLocal, memory_order_relaxed);
+    if (aDelta != 0)
+    {
+        atomic_fetch_add_explicit(&ioGaugePtr->mGlobal, aDelta, memory_order_relaxed);
+        atomic_store_explicit(&ioGaugePtr->mSlots[iThread].mLocal, 0, memory_order_release);
+    }
+}
+
+void Gauge_add(tGauge *ioGaugePtr, const uint32_t iThread, const int32_t iDelta)
+{
+    int64_t aDelta;
+    _Atomic int64_t *aLocal;
+
+    if (ioGaugePtr == NULL)
+    {
+        return;
+    }
+
+    assert(iThread < ioGaugePtr->mThreads);
+    aLocal = &ioGaugePtr->mSlots[iThread].mLocal;
+
+    aDelta = atomic_load_explicit(aLocal, memory_order_relaxed) + iDelta;
+    if (aDelta >= (int64_t)ioGaugePtr->mThreshold || -aDelta >= (int64_t)ioGaugePtr->mThreshold)
+    {
+        // move to global before clearing the slot; the release store pairs
+        // with the acquire load in Gauge_getExact so a cleared slot implies
+        // the delta is already in the global value
+        atomic_fetch_add_explicit(&ioGaugePtr->mGlobal, aDelta, memory_order_relaxed);
+        atomic_store_explicit(aLocal, 0, memory_order_release);
+    }
+    else
+    {
+        atomic_store_explicit(aLocal, aDelta, memory_order_release);
+    }
+}
+
+void Gauge_get(tGauge *ioGaugePtr, int64_t *oValue)
+{
+    if (ioGaugePtr == NULL)
+    {
+        return;
+    }
+
+    *oValue = atomic_load_explicit(&ioGaugePtr->mGlobal, memory_order_acquire);
+}
+
+void Gauge_getExact(tGauge *ioGaugePtr, int64_t *oValue)
+{
+    int64_t aValue;
+    uint32_t aThread;
+
+    if (ioGaugePtr == NULL)
+    {
+        return;
+    }
+
+    // slots before global: any delta moved out of a slot already read as
+    // cleared is visible in the global value, so none is missed
+    aValue = 0;
+    for (aThread = 0; aThread < ioGaugePtr->mThreads; ++aThread)
+    {
+        aValue += atomic_load_explicit(&ioGaugePtr->mSlots[aThread].mLocal, memory_order_acquire);
+    }
+    *oValue = aValue + atomic_load_explicit(&ioGaugePtr->mGlobal, memory_order_relaxed);
+}
+
+int64_t Gauge_errorBound(const tGauge *iGaugePtr)
+{
+    return (int64_t)iGaugePtr->mThreads * ((int64_t)iGaugePtr->mThreshold - 1);
+}
@@ -0,0 +1,416 @@
+#include <HierarchicalCounter.h>
+#include <assert.h>
+#include <counter_platform.h>
+#include <memory.h>
+#include <sched.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/**
+ * @brief A per-thread slot or an intermediate node, one cache line each.
+ */
+typedef struct
+{
+    alignas(kCounter_cacheLineSize) _Atomic uint32_t mCount; // pending count
+} tHierarchicalCounter_slot;
+
+/**
+ * @brief Two-level combining tree counter.
+ *
+ * Threads accumulate in mLocal, flush into the mNode of the CPU group they are
+ * running on when crossing mThreshold, and nodes flush into mRoot when
+ * crossing mNodeThreshold. All transfers are an exchange on the source and a
+ * fetch_add on the destination, so no count is lost or counted twice.
+ */
+typedef struct
+{
+    tCounter_instance mBase;           // base class (must be first field)
+    uint32_t mThreshold;               // local to node update frequency
+    uint32_t mNodeThreshold;           // node to root update frequency
+    uint32_t mThreads;                 // number of local counter threads
+    uint32_t mNodes;                   // number of intermediate nodes
+    uint32_t mCpus;                    // number of entries in mCpuNode
+    uint32_t *mCpuNode;                // node index of each CPU
+    tHierarchicalCounter_slot *mLocal; // local counts (one per thread)
+    tHierarchicalCounter_slot *mNode;  // node counts (one per CPU group)
+    tHierarchicalCounter_slot mRoot;   // root count
+} tHierarchicalCounter_instance;
+
+/**
+ * @brief Read the first unsigned integer of a sysfs file.
+ *
+ * Works for plain values ("3") and for CPU lists ("0-7,16-23"), where it yields
+ * the lowest CPU of the list.
+ *
+ * @param iPathPtr File to read.
+ * @param oValuePtr Address to write the value to.
+ * @return Zero on success, non-zero if the file is missing or malformed.
+ */
+static int HierarchicalCounter_readSysfs(const char *iPathPtr, uint32_t *oValuePtr)
+{
+    int aStatusCode;
+    FILE *aFilePtr;
+
+    aFilePtr = fopen(iPathPtr, "r");
+    if (aFilePtr == NULL)
+    {
+        return 1;
+    }
+    aStatusCode = (fscanf(aFilePtr, "%u", oValuePtr) == 1) ? 0 : 1;
+    fclose(aFilePtr);
+    return aStatusCode;
+}
+
+/**
+ * @brief Compute a grouping key for a CPU from /sys/devices/system/cpu.
+ *
+ * For LLC grouping the key is the lowest CPU sharing the highest-level cache
+ * of iCpu; for package grouping it is the physical package id.
+ *
+ * @param iCpu CPU to look up.
+ * @param iGroup Grouping to use.
+ * @param oKeyPtr Address to write the key to.
+ * @return Zero on success, non-zero if the topology is not available.
+ */
+static int HierarchicalCounter_groupKey(uint32_t iCpu,
+                                        tHierarchicalCounter_group iGroup,
+                                        uint32_t *oKeyPtr)
+{
+    char aPath[128];
+    uint32_t aIndex;
+    uint32_t aLevel;
+    uint32_t aTopLevel;
+    uint32_t aTopIndex;
+
+    if (iGroup == kHierarchicalCounter_groupPackage)
+    {
+        snprintf(aPath, sizeof(aPath), "/sys/devices/system/cpu/cpu%u/topology/physical_package_id", iCpu);
+        return HierarchicalCounter_readSysfs(aPath, oKeyPtr);
+    }
+
+    // find the highest cache level of this CPU
+    aTopLevel = 0;
+    aTopIndex = 0;
+    for (aIndex = 0;; ++aIndex)
+    {
+        snprintf(aPath, sizeof(aPath), "/sys/devices/system/cpu/cpu%u/cache/index%u/level", iCpu, aIndex);
+        if (HierarchicalCounter_readSysfs(aPath, &aLevel) != 0)
+        {
+            break;
+        }
+        if (aLevel > aTopLevel)
+        {
+            aTopLevel = aLevel;
+            aTopIndex = aIndex;
+        }
+    }
+    if (aTopLevel == 0)
+    {
+        return 1;
+    }
+
+    snprintf(aPath, sizeof(aPath), "/sys/devices/system/cpu/cpu%u/cache/index%u/shared_cpu_list", iCpu, aTopIndex);
+    return HierarchicalCounter_readSysfs(aPath, oKeyPtr);
+}
+
+/**
+ * @brief Build the CPU to node map. CPUs whose topology cannot be read all go
+ *        to node 0.
+ *
+ * @param ioCounterPtr Counter whose mCpus is set; fills mCpuNode and mNodes.
+ * @param iGroup Grouping to use.
+ */
+static void HierarchicalCounter_mapCpus(tHierarchicalCounter_instance *ioCounterPtr,
+                                        tHierarchicalCounter_group iGroup)
+{
+    uint32_t aCpu;
+    uint32_t aKey;
+    uint32_t aNode;
+    uint32_t *aKeys;
+
+    aKeys = malloc(ioCounterPtr->mCpus * sizeof(uint32_t));
+    assert(aKeys != NULL);
+
+    ioCounterPtr->mNodes = 0;
+    for (aCpu = 0; aCpu < ioCounterPtr->mCpus; ++aCpu)
+    {
+        if (HierarchicalCounter_groupKey(aCpu, iGroup, &aKey) != 0)
+        {
+            aKey = UINT32_MAX;
+        }
+
+        // dense node index in order of first appearance of the key
+        for (aNode = 0; aNode < ioCounterPtr->mNodes; ++aNode)
+        {
+            if (aKeys[aNode] == aKey)
+            {
+                break;
+            }
+        }
+        if (aNode == ioCounterPtr->mNodes)
+        {
+            aKeys[ioCounterPtr->mNodes++] = aKey;
+        }
+        ioCounterPtr->mCpuNode[aCpu] = aNode;
+    }
+
+    free(aKeys);
+}
+
+/**
+ * @brief Allocate and initialize the hierarchical counter.
+ *
+ * @param iBasePtr Counter base to initialize.
+ * @param iOptionsPtr Pointer to tHierarchicalCounter_options, or NULL for defaults.
+ * @return Pointer to new counter instance.
+ */
+static tCounter_instance *HierarchicalCounter_create(const tCounter_instance *iBasePtr, const void *iOptionsPtr)
+{
+    long aCpus;
+    uint32_t aIndex;
+    tHierarchicalCounter_options aOptions;
+    tHierarchicalCounter_instance *aCounterPtr;
+
+    assert(iBasePtr != NULL); // required parameter
+
+    // get options
+    if (iOptionsPtr != NULL)
+    {
+        aOptions = *(const tHierarchicalCounter_options *)iOptionsPtr;
+    }
+    else
+    {
+        // use defaults
+        aOptions.mThreshold = 1024;
+        aOptions.mNodeThreshold = 8 * 1024;
+        aOptions.mThreads = 8;
+        aOptions.mGroup = kHierarchicalCounter_groupLlc;
+    }
+
+    // allocate hierarchical counter instance (cache-line aligned for mRoot)
+    aCounterPtr = aligned_alloc(kCounter_cacheLineSize, sizeof(tHierarchicalCounter_instance));
+    assert(aCounterPtr != NULL);
+    memset(aCounterPtr, 0, sizeof(tHierarchicalCounter_instance)); // blank slate
+
+    // copy the base into the instance
+    memcpy(aCounterPtr, iBasePtr, sizeof(tCounter_instance));
+
+    // initialize counter shallow state
+    aCounterPtr->mThreshold = aOptions.mThreshold;
+    aCounterPtr->mNodeThreshold = aOptions.mNodeThreshold;
+    aCounterPtr->mThreads = aOptions.mThreads;
+    atomic_init(&aCounterPtr->mRoot.mCount, 0);
+
+    // read the topology
+    aCpus = sysconf(_SC_NPROCESSORS_CONF);
+    aCounterPtr->mCpus = (aCpus > 0) ? (uint32_t)aCpus : 1;
+    aCounterPtr->mCpuNode = malloc(aCounterPtr->mCpus * sizeof(uint32_t));
+    assert(aCounterPtr->mCpuNode != NULL);
+    HierarchicalCounter_mapCpus(aCounterPtr, aOptions.mGroup);
+
+    // allocate counter heap state
+    aCounterPtr->mLocal = aligned_alloc(kCounter_cacheLineSize,
+                                        aCounterPtr->mThreads * sizeof(tHierarchicalCounter_slot));
+    aCounterPtr->mNode = aligned_alloc(kCounter_cacheLineSize,
+                                       aCounterPtr->mNodes * sizeof(tHierarchicalCounter_slot));
+    assert(aCounterPtr->mLocal != NULL && aCounterPtr->mNode != NULL);
+    for (aIndex = 0; aIndex < aCounterPtr->mThreads; ++aIndex)
+    {
+        atomic_init(&aCounterPtr->mLocal[aIndex].mCount, 0);
+    }
+    for (aIndex = 0; aIndex < aCounterPtr->mNodes; ++aIndex)
+    {
+        atomic_init(&aCounterPtr->mNode[aIndex].mCount, 0);
+    }
+
+    return (tCounter_instance *)aCounterPtr;
+}
+
+/**
+ * @brief Clean up counter resources. Free all memory allocated in _create.
+ *
+ * @param ioInstancePtr Counter instance to destroy.
+ */
+static void HierarchicalCounter_destroy(tCounter_instance *ioInstancePtr)
+{
+    tHierarchicalCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tHierarchicalCounter_instance *)ioInstancePtr;
+
+    free(aCounterPtr->mCpuNode);
+    free(aCounterPtr->mLocal);
+    free(aCounterPtr->mNode);
+    free(aCounterPtr);
+}
+
+/**
+ * @brief Reset all counts to zero. Writers must be quiescent.
+ *
+ * @param ioInstancePtr Counter to reset.
+ */
+static void HierarchicalCounter_reset(tCounter_instance *ioInstancePtr)
+{
+    uint32_t aIndex;
+    tHierarchicalCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tHierarchicalCounter_instance *)ioInstancePtr;
+
+    for (aIndex = 0; aIndex < aCounterPtr->mThreads; ++aIndex)
+    {
+        atomic_store_explicit(&aCounterPtr->mLocal[aIndex].mCount, 0, memory_order_relaxed);
+    }
+    for (aIndex = 0; aIndex < aCounterPtr->mNodes; ++aIndex)
+    {
+        atomic_store_explicit(&aCounterPtr->mNode[aIndex].mCount, 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&aCounterPtr->mRoot.mCount, 0, memory_order_release);
+}
+
+/**
+ * @brief Add a thread's drained local count to the node of the current CPU,
+ *        passing the node on to the root when it crosses its threshold.
+ *
+ * @param ioCounterPtr Counter to update.
+ * @param iCount Count drained from a local slot.
+ */
+static void HierarchicalCounter_pushToNode(tHierarchicalCounter_instance *ioCounterPtr,
+                                           uint32_t iCount)
+{
+    int aCpu;
+    uint32_t aNodeCount;
+    _Atomic uint32_t *aNode;
+
+    aCpu = sched_getcpu();
+    if (aCpu < 0)
+    {
+        aCpu = 0;
+    }
+    aNode = &ioCounterPtr->mNode[ioCounterPtr->mCpuNode[(uint32_t)aCpu % ioCounterPtr->mCpus]].mCount;
+
+    aNodeCount = atomic_fetch_add_explicit(aNode, iCount, memory_order_relaxed) + iCount;
+    if (aNodeCount >= ioCounterPtr->mNodeThreshold)
+    {
+        aNodeCount = atomic_exchange_explicit(aNode, 0, memory_order_relaxed);
+        if (aNodeCount != 0)
+        {
+            atomic_fetch_add_explicit(&ioCounterPtr->mRoot.mCount, aNodeCount, memory_order_release);
+        }
+    }
+}
+
+/**
+ * @brief Flush thread's local count to its node.
+ *
+ * @param ioInstancePtr Counter instance.
+ * @param iThread Thread ID to flush.
+ */
+static void HierarchicalCounter_flush(tCounter_instance *ioInstancePtr,
+                                      const uint32_t iThread)
+{
+    uint32_t aCount;
+    tHierarchicalCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tHierarchicalCounter_instance *)ioInstancePtr;
+
+    aCount = atomic_exchange_explicit(&aCounterPtr->mLocal[iThread].mCount, 0, memory_order_relaxed);
+    if (aCount != 0)
+    {
+        HierarchicalCounter_pushToNode(aCounterPtr, aCount);
+    }
+}
+
+/**
+ * @brief Increment thread-local counter, flushing to the node when the
+ *        threshold is reached.
+ *
+ * @param ioInstancePtr Counter to update.
+ * @param iThread Thread ID (0 to num_threads-1) of the caller.
+ * @param iAmount Amount to add to local counter.
+ */
+static void HierarchicalCounter_increment(tCounter_instance *ioInstancePtr,
+                                          const uint32_t iThread,
+                                          const uint32_t iAmount)
+{
+    uint32_t aCount;
+    _Atomic uint32_t *aLocal;
+    tHierarchicalCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tHierarchicalCounter_instance *)ioInstancePtr;
+    aLocal = &aCounterPtr->mLocal[iThread].mCount;
+
+    aCount = atomic_load_explicit(aLocal, memory_order_relaxed) + iAmount;
+    if (aCount >= aCounterPtr->mThreshold)
+    {
+        atomic_store_explicit(aLocal, 0, memory_order_relaxed);
+        HierarchicalCounter_pushToNode(aCounterPtr, aCount);
+    }
+    else
+    {
+        atomic_store_explicit(aLocal, aCount, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Get hierarchical counter value.
+ *
+ * Returns the root count plus the counts pending in the nodes; unflushed
+ * local counts are not included.
+ *
+ * @param ioInstancePtr Counter to read from.
+ * @param oCount Pointer to write count to.
+ */
+static void HierarchicalCounter_get(tCounter_instance *ioInstancePtr,
+                                    uint32_t *oCount)
+{
+    uint32_t aNode;
+    uint32_t aCount;
+    tHierarchicalCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tHierarchicalCounter_instance *)ioInstancePtr;
+
+    aCount = atomic_load_explicit(&aCounterPtr->mRoot.mCount, memory_order_acquire);
+    for (aNode = 0; aNode < aCounterPtr->mNodes; ++aNode)
+    {
+        aCount += atomic_load_explicit(&aCounterPtr->mNode[aNode].mCount, memory_order_relaxed);
+    }
+
+    *oCount = aCount;
+}
+
+const tCounter_interface gHierarchicalCounter_interface =
+    {
+        HierarchicalCounter_create,
+        HierarchicalCounter_destroy,
+        HierarchicalCounter_reset,
+        HierarchicalCounter_flush,
+        HierarchicalCounter_increment,
+        HierarchicalCounter_get};
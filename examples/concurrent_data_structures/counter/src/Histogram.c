@@ -0,0 +1,247 @@
+#include <Histogram.h>
+#include <assert.h>
+#include <counter_platform.h>
+#include <memory.h>
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * Buckets: values below 2^S (S = sub-bucket bits) get one bucket each. A value
+ * with its top bit at b >= S goes to group g = b - S + 1, which splits
+ * [2^b, 2^(b+1)) into 2^S buckets of width 2^(g-1). Groups run up to b = 63.
+ */
+
+struct __tHistogram
+{
+    uint32_t mThreads;       // number of rows
+    uint32_t mSubBucketBits; // S
+    uint32_t mBucketCount;   // buckets per row
+    size_t mRowStride;       // bytes between rows (whole cache lines)
+    _Atomic uint64_t *mRows; // per-thread bucket counts, only written by their owner
+
+    pthread_mutex_t mResetLock; // serializes reset and snapshot
+    uint64_t *mBaselinePtr;     // merged counts at the last reset
+};
+
+/**
+ * @brief Bucket index of a value.
+ */
+static inline uint32_t Histogram_bucket(const uint32_t iSubBucketBits, const uint64_t iValue)
+{
+    uint32_t aTopBit;
+
+    if (iValue < ((uint64_t)1 << iSubBucketBits))
+    {
+        return (uint32_t)iValue;
+    }
+
+    aTopBit = 63 - (uint32_t)__builtin_clzll(iValue);
+    return ((aTopBit - iSubBucketBits + 1) << iSubBucketBits) +
+           (uint32_t)((iValue >> (aTopBit - iSubBucketBits)) & (((uint64_t)1 << iSubBucketBits) - 1));
+}
+
+/**
+ * @brief Highest value that falls into a bucket.
+ */
+static inline uint64_t Histogram_bucketMax(const uint32_t iSubBucketBits, const uint32_t iBucket)
+{
+    uint32_t aGroup;
+    uint64_t aOffset;
+
+    aGroup = iBucket >> iSubBucketBits;
+    if (aGroup == 0)
+    {
+        return iBucket;
+    }
+
+    aOffset = iBucket & (((uint32_t)1 << iSubBucketBits) - 1);
+    return (((((uint64_t)1 << iSubBucketBits) + aOffset + 1) << (aGroup - 1))) - 1;
+}
+
+/**
+ * @brief Address of a thread's row of buckets.
+ */
+static inline _Atomic uint64_t *Histogram_row(const tHistogram *iHistogramPtr, const uint32_t iThread)
+{
+    return (_Atomic uint64_t *)((char *)iHistogramPtr->mRows + iThread * iHistogramPtr->mRowStride);
+}
+
+/**
+ * @brief Sum the rows into ioCounts (mBucketCount entries).
+ */
+static void Histogram_sumRows(const tHistogram *iHistogramPtr, uint64_t *ioCounts)
+{
+    uint32_t aThread;
+    uint32_t aBucket;
+    _Atomic uint64_t *aRow;
+
+    memset(ioCounts, 0, iHistogramPtr->mBucketCount * sizeof(uint64_t));
+    for (aThread = 0; aThread < iHistogramPtr->mThreads; ++aThread)
+    {
+        aRow = Histogram_row(iHistogramPtr, aThread);
+        for (aBucket = 0; aBucket < iHistogramPtr->mBucketCount; ++aBucket)
+        {
+            ioCounts[aBucket] += atomic_load_explicit(&aRow[aBucket], memory_order_relaxed);
+        }
+    }
+}
+
+tHistogram *Histogram_create(const tHistogram_options *iOptionsPtr)
+{
+    uint32_t aStatusCode;
+    uint32_t aThread;
+    uint32_t aBucket;
+    _Atomic uint64_t *aRow;
+    tHistogram *aHistogramPtr;
+
+    assert(iOptionsPtr != NULL);              // required parameter
+    assert(iOptionsPtr->mThreads);            // need at least one row
+    assert(iOptionsPtr->mSubBucketBits < 16); // keep rows a sane size
+
+    aHistogramPtr = malloc(sizeof(tHistogram));
+    assert(aHistogramPtr != NULL);
+    memset(aHistogramPtr, 0, sizeof(tHistogram)); // blank slate
+
+    aHistogramPtr->mThreads = iOptionsPtr->mThreads;
+    aHistogramPtr->mSubBucketBits = (iOptionsPtr->mSubBucketBits != 0) ? iOptionsPtr->mSubBucketBits : 5;
+    aHistogramPtr->mBucketCount = (64 - aHistogramPtr->mSubBucketBits + 1) << aHistogramPtr->mSubBucketBits;
+
+    aHistogramPtr->mRowStride = Counter_cacheLineRound(aHistogramPtr->mBucketCount * sizeof(uint64_t));
+    aHistogramPtr->mRows = aligned_alloc(kCounter_cacheLineSize, aHistogramPtr->mThreads * aHistogramPtr->mRowStride);
+    assert(aHistogramPtr->mRows != NULL);
+    for (aThread = 0; aThread < aHistogramPtr->mThreads; ++aThread)
+    {
+        aRow = Histogram_row(aHistogramPtr, aThread);
+        for (aBucket = 0; aBucket < aHistogramPtr->mBucketCount; ++aBucket)
+        {
+            atomic_init(&aRow[aBucket], 0);
+        }
+    }
+
+    aHistogramPtr->mBaselinePtr = calloc(aHistogramPtr->mBucketCount, sizeof(uint64_t));
+    assert(aHistogramPtr->mBaselinePtr != NULL);
+    aStatusCode = pthread_mutex_init(&aHistogramPtr->mResetLock, NULL);
+    assert(aStatusCode == 0);
+
+    return aHistogramPtr;
+}
+
+void Histogram_destroy(tHistogram *ioHistogramPtr)
+{
+    if (ioHistogramPtr == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_destroy(&ioHistogramPtr->mResetLock);
+    free(ioHistogramPtr->mBaselinePtr);
+    free(ioHistogramPtr->mRows);
+    free(ioHistogramPtr);
+}
+
+void Histogram_record(tHistogram *ioHistogramPtr, const uint32_t iThread, const uint64_t iValue)
+{
+    _Atomic uint64_t *aCount;
+
+    assert(iThread < ioHistogramPtr->mThreads);
+
+    aCount = &Histogram_row(ioHistogramPtr, iThread)[Histogram_bucket(ioHistogramPtr->mSubBucketBits, iValue)];
+
+    atomic_store_explicit(aCount, atomic_load_explicit(aCount, memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+void Histogram_reset(tHistogram *ioHistogramPtr)
+{
+    if (ioHistogramPtr == NULL)
+    {
+        return;
+    }
+
+    // rows only grow, so instead of zeroing them under the writers' feet,
+    // remember where they are and subtract that from later snapshots
+    pthread_mutex_lock(&ioHistogramPtr->mResetLock);
+    Histogram_sumRows(ioHistogramPtr, ioHistogramPtr->mBaselinePtr);
+    pthread_mutex_unlock(&ioHistogramPtr->mResetLock);
+}
+
+void Histogram_snapshot(tHistogram *ioHistogramPtr, tHistogram_snapshot *oSnapshotPtr)
+{
+    uint32_t aBucket;
+
+    oSnapshotPtr->mSubBucketBits = ioHistogramPtr->mSubBucketBits;
+    oSnapshotPtr->mBucketCount = ioHistogramPtr->mBucketCount;
+    oSnapshotPtr->mCountsPtr = malloc(oSnapshotPtr->mBucketCount * sizeof(uint64_t));
+    assert(oSnapshotPtr->mCountsPtr != NULL);
+
+    pthread_mutex_lock(&ioHistogramPtr->mResetLock);
+    Histogram_sumRows(ioHistogramPtr, oSnapshotPtr->mCountsPtr);
+    oSnapshotPtr->mTotal = 0;
+    for (aBucket = 0; aBucket < oSnapshotPtr->mBucketCount; ++aBucket)
+    {
+        oSnapshotPtr->mCountsPtr[aBucket] -= ioHistogramPtr->mBaselinePtr[aBucket];
+        oSnapshotPtr->mTotal += oSnapshotPtr->mCountsPtr[aBucket];
+    }
+    pthread_mutex_unlock(&ioHistogramPtr->mResetLock);
+}
+
+void Histogram_snapshotMerge(tHistogram_snapshot *ioIntoPtr, const tHistogram_snapshot *iFromPtr)
+{
+    uint32_t aBucket;
+
+    assert(ioIntoPtr->mSubBucketBits == iFromPtr->mSubBucketBits); // same layout only
+
+    for (aBucket = 0; aBucket < ioIntoPtr->mBucketCount; ++aBucket)
+    {
+        ioIntoPtr->mCountsPtr[aBucket] += iFromPtr->mCountsPtr[aBucket];
+    }
+    ioIntoPtr->mTotal += iFromPtr->mTotal;
+}
+
+uint64_t Histogram_snapshotPercentile(const tHistogram_snapshot *iSnapshotPtr, double iPercentile)
+{
+    uint32_t aBucket;
+    uint64_t aRank;
+    uint64_t aSeen;
+
+    if (iSnapshotPtr->mTotal == 0)
+    {
+        return 0;
+    }
+
+    // rank of the wanted value, 1-based, at least the first value
+    aRank = (uint64_t)(iPercentile / 100.0 * (double)iSnapshotPtr->mTotal + 0.5);
+    if (aRank == 0)
+    {
+        aRank = 1;
+    }
+    if (aRank > iSnapshotPtr->mTotal)
+    {
+        aRank = iSnapshotPtr->mTotal;
+    }
+
+    aSeen = 0;
+    for (aBucket = 0; aBucket < iSnapshotPtr->mBucketCount; ++aBucket)
+    {
+        aSeen += iSnapshotPtr->mCountsPtr[aBucket];
+        if (aSeen >= aRank)
+        {
+            break;
+        }
+    }
+    return Histogram_bucketMax(iSnapshotPtr->mSubBucketBits, aBucket);
+}
+
+void Histogram_snapshotFree(tHistogram_snapshot *ioSnapshotPtr)
+{
+    if (ioSnapshotPtr == NULL)
+    {
+        return;
+    }
+
+    free(ioSnapshotPtr->mCountsPtr);
+    ioSnapshotPtr->mCountsPtr = NULL;
+    ioSnapshotPtr->mTotal = 0;
+}
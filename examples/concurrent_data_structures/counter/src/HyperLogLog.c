@@ -0,0 +1,177 @@
+#include <HyperLogLog.h>
+#include <assert.h>
+#include <counter_platform.h>
+#include <math.h>
+#include <memory.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+struct __tHyperLogLog
+{
+    uint32_t mThreads;   // number of rows
+    uint32_t mPrecision; // p
+    size_t mRegisters;   // m = 2^p, also the row stride (a multiple of the cache line)
+    uint8_t *mRows;      // per-thread registers, only written by their owner
+    double mAlpha;       // bias correction alpha_m * m^2
+};
+
+/**
+ * @brief ioInto[i] = max(ioInto[i], iFrom[i]) for a whole row.
+ *
+ * Rows are cache-line aligned and a multiple of 64 bytes long, so the vector
+ * loops need no tail.
+ */
+static void HyperLogLog_maxRow(uint8_t *ioInto, const uint8_t *iFrom, const size_t iBytes)
+{
+    size_t aByte;
+
+#if defined(__AVX2__)
+    for (aByte = 0; aByte < iBytes; aByte += 32)
+    {
+        _mm256_store_si256((__m256i *)&ioInto[aByte],
+                           _mm256_max_epu8(_mm256_load_si256((const __m256i *)&ioInto[aByte]),
+                                           _mm256_load_si256((const __m256i *)&iFrom[aByte])));
+    }
+#elif defined(__SSE2__)
+    for (aByte = 0; aByte < iBytes; aByte += 16)
+    {
+        _mm_store_si128((__m128i *)&ioInto[aByte],
+                        _mm_max_epu8(_mm_load_si128((const __m128i *)&ioInto[aByte]),
+                                     _mm_load_si128((const __m128i *)&iFrom[aByte])));
+    }
+#elif defined(__ARM_NEON)
+    for (aByte = 0; aByte < iBytes; aByte += 16)
+    {
+        vst1q_u8(&ioInto[aByte], vmaxq_u8(vld1q_u8(&ioInto[aByte]), vld1q_u8(&iFrom[aByte])));
+    }
+#else
+    for (aByte = 0; aByte < iBytes; ++aByte)
+    {
+        ioInto[aByte] = (iFrom[aByte] > ioInto[aByte]) ? iFrom[aByte] : ioInto[aByte];
+    }
+#endif
+}
+
+tHyperLogLog *HyperLogLog_create(const tHyperLogLog_options *iOptionsPtr)
+{
+    tHyperLogLog *aSketchPtr;
+
+    assert(iOptionsPtr != NULL);   // required parameter
+    assert(iOptionsPtr->mThreads); // need at least one row
+
+    aSketchPtr = malloc(sizeof(tHyperLogLog));
+    assert(aSketchPtr != NULL);
+    memset(aSketchPtr, 0, sizeof(tHyperLogLog)); // blank slate
+
+    aSketchPtr->mThreads = iOptionsPtr->mThreads;
+    aSketchPtr->mPrecision = (iOptionsPtr->mPrecision != 0) ? iOptionsPtr->mPrecision : 14;
+    assert(aSketchPtr->mPrecision >= 6 && aSketchPtr->mPrecision <= 18); // rows of whole cache lines
+    aSketchPtr->mRegisters = (size_t)1 << aSketchPtr->mPrecision;
+    aSketchPtr->mAlpha = 0.7213 / (1.0 + 1.079 / (double)aSketchPtr->mRegisters) *
+                         (double)aSketchPtr->mRegisters * (double)aSketchPtr->mRegisters;
+
+    aSketchPtr->mRows = aligned_alloc(kCounter_cacheLineSize, aSketchPtr->mThreads * aSketchPtr->mRegisters);
+    assert(aSketchPtr->mRows != NULL);
+    HyperLogLog_reset(aSketchPtr);
+
+    return aSketchPtr;
+}
+
+void HyperLogLog_destroy(tHyperLogLog *ioSketchPtr)
+{
+    if (ioSketchPtr == NULL)
+    {
+        return;
+    }
+
+    free(ioSketchPtr->mRows);
+    free(ioSketchPtr);
+}
+
+void HyperLogLog_reset(tHyperLogLog *ioSketchPtr)
+{
+    if (ioSketchPtr == NULL)
+    {
+        return;
+    }
+
+    memset(ioSketchPtr->mRows, 0, ioSketchPtr->mThreads * ioSketchPtr->mRegisters);
+}
+
+void HyperLogLog_flush(tHyperLogLog *ioSketchPtr, const uint32_t iThread)
+{
+    (void)ioSketchPtr;
+    (void)iThread;
+}
+
+void HyperLogLog_add(tHyperLogLog *ioSketchPtr, const uint32_t iThread, const uint64_t iItem)
+{
+    uint64_t aHash;
+    uint8_t aRank;
+    uint8_t *aRegister;
+
+    assert(iThread < ioSketchPtr->mThreads);
+
+    // top p bits pick the register, the rank is the position of the first 1
+    // in the remaining bits (a sentinel bit bounds it at 64 - p + 1)
+    aHash = Counter_hash64(iItem);
+    aRegister = &ioSketchPtr->mRows[iThread * ioSketchPtr->mRegisters + (aHash >> (64 - ioSketchPtr->mPrecision))];
+    aRank = (uint8_t)(__builtin_clzll((aHash << ioSketchPtr->mPrecision) |
+                                      ((uint64_t)1 << (ioSketchPtr->mPrecision - 1))) +
+                      1);
+
+    // registers are bytes, so a concurrent merge sees the old or the new
+    // value; only the owner writes, and only to raise
+    if (aRank > __atomic_load_n(aRegister, __ATOMIC_RELAXED))
+    {
+        __atomic_store_n(aRegister, aRank, __ATOMIC_RELAXED);
+    }
+}
+
+void HyperLogLog_get(tHyperLogLog *ioSketchPtr, uint64_t *oEstimate)
+{
+    uint32_t aThread;
+    size_t aRegister;
+    uint32_t aZeros;
+    double aSum;
+    double aEstimate;
+    uint8_t *aMerged;
+
+    if (ioSketchPtr == NULL)
+    {
+        return;
+    }
+
+    aMerged = aligned_alloc(kCounter_cacheLineSize, ioSketchPtr->mRegisters);
+    assert(aMerged != NULL);
+    memcpy(aMerged, ioSketchPtr->mRows, ioSketchPtr->mRegisters);
+    for (aThread = 1; aThread < ioSketchPtr->mThreads; ++aThread)
+    {
+        HyperLogLog_maxRow(aMerged, &ioSketchPtr->mRows[aThread * ioSketchPtr->mRegisters], ioSketchPtr->mRegisters);
+    }
+
+    // harmonic mean of 2^register
+    aSum = 0.0;
+    aZeros = 0;
+    for (aRegister = 0; aRegister < ioSketchPtr->mRegisters; ++aRegister)
+    {
+        aSum += ldexp(1.0, -(int)aMerged[aRegister]);
+        aZeros += (aMerged[aRegister] == 0);
+    }
+    free(aMerged);
+
+    aEstimate = ioSketchPtr->mAlpha / aSum;
+    if (aEstimate <= 2.5 * (double)ioSketchPtr->mRegisters && aZeros != 0)
+    {
+        // small range: linear counting on the empty registers
+        aEstimate = (double)ioSketchPtr->mRegisters * log((double)ioSketchPtr->mRegisters / (double)aZeros);
+    }
+
+    *oEstimate = (uint64_t)(aEstimate + 0.5);
+}
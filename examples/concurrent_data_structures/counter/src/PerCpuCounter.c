@@ -0,0 +1,215 @@
+#include <PerCpuCounter.h>
+#include <assert.h>
+#include <counter_platform.h>
+#include <memory.h>
+#include <sched.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/**
+ * @brief Per-CPU shard, one cache line each.
+ */
+typedef struct
+{
+    alignas(kCounter_cacheLineSize) _Atomic uint32_t mCount; // shard count
+} tPerCpuCounter_shard;
+
+/**
+ * @brief Exact counter sharded by CPU rather than by caller thread.
+ *
+ * A thread can be migrated between reading its CPU number and updating the
+ * shard, so shard updates are atomic read-modify-writes. They stay cheap
+ * because the line is almost always already owned by the updating CPU.
+ */
+typedef struct
+{
+    tCounter_instance mBase;      // base class (must be first field)
+    uint32_t mShards;             // number of shards
+    tPerCpuCounter_shard *mShard; // shard counts (one per CPU)
+} tPerCpuCounter_instance;
+
+/**
+ * @brief Allocate and initialize the per-CPU counter.
+ *
+ * @param iBasePtr Counter base to initialize.
+ * @param iOptionsPtr Pointer to tPerCpuCounter_options, or NULL for one shard
+ *                    per configured CPU.
+ * @return Pointer to new counter instance.
+ */
+static tCounter_instance *PerCpuCounter_create(const tCounter_instance *iBasePtr, const void *iOptionsPtr)
+{
+    long aCpus;
+    uint32_t aShard;
+    uint32_t aShards;
+    tPerCpuCounter_instance *aCounterPtr;
+
+    assert(iBasePtr != NULL); // required parameter
+
+    // get options
+    aShards = 0;
+    if (iOptionsPtr != NULL)
+    {
+        aShards = ((const tPerCpuCounter_options *)iOptionsPtr)->mShards;
+    }
+    if (aShards == 0)
+    {
+        // CPU ids reported by sched_getcpu range over the configured CPUs,
+        // not just the ones online right now
+        aCpus = sysconf(_SC_NPROCESSORS_CONF);
+        aShards = (aCpus > 0) ? (uint32_t)aCpus : 1;
+    }
+
+    // allocate per-CPU counter instance
+    aCounterPtr = malloc(sizeof(tPerCpuCounter_instance));
+    assert(aCounterPtr != NULL);
+    memset(aCounterPtr, 0, sizeof(tPerCpuCounter_instance)); // blank slate
+
+    // copy the base into the instance
+    memcpy(aCounterPtr, iBasePtr, sizeof(tCounter_instance));
+
+    // allocate counter heap state
+    aCounterPtr->mShards = aShards;
+    aCounterPtr->mShard = aligned_alloc(kCounter_cacheLineSize,
+                                        aShards * sizeof(tPerCpuCounter_shard));
+    assert(aCounterPtr->mShard != NULL);
+    for (aShard = 0; aShard < aShards; ++aShard)
+    {
+        atomic_init(&aCounterPtr->mShard[aShard].mCount, 0);
+    }
+
+    return (tCounter_instance *)aCounterPtr;
+}
+
+/**
+ * @brief Clean up counter resources. Free all memory allocated in _create.
+ *
+ * @param ioInstancePtr Counter instance to destroy.
+ */
+static void PerCpuCounter_destroy(tCounter_instance *ioInstancePtr)
+{
+    tPerCpuCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tPerCpuCounter_instance *)ioInstancePtr;
+
+    free(aCounterPtr->mShard);
+    free(aCounterPtr);
+}
+
+/**
+ * @brief Reset all shards to zero.
+ *
+ * @param ioInstancePtr Counter to reset.
+ */
+static void PerCpuCounter_reset(tCounter_instance *ioInstancePtr)
+{
+    uint32_t aShard;
+    tPerCpuCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tPerCpuCounter_instance *)ioInstancePtr;
+
+    for (aShard = 0; aShard < aCounterPtr->mShards; ++aShard)
+    {
+        atomic_store_explicit(&aCounterPtr->mShard[aShard].mCount, 0, memory_order_relaxed);
+    }
+    atomic_thread_fence(memory_order_release);
+}
+
+/**
+ * @brief Flush pending updates.
+ *
+ * No-op for per-CPU counter (readers aggregate the shards directly).
+ *
+ * @param ioInstancePtr Counter instance.
+ * @param iThread Ignored.
+ */
+static void PerCpuCounter_flush(tCounter_instance *ioInstancePtr, const uint32_t iThread)
+{
+    // Do nothing - there is no global count to flush into
+}
+
+/**
+ * @brief Add to the shard of the CPU the caller is running on.
+ *
+ * sched_getcpu is served from the vDSO (or from the thread's rseq area on
+ * recent glibc), so picking the shard does not enter the kernel.
+ *
+ * @param ioInstancePtr Counter to update.
+ * @param iThread Ignored (the shard follows the current CPU).
+ * @param iAmount Amount to add to counter.
+ */
+static void PerCpuCounter_increment(tCounter_instance *ioInstancePtr,
+                                    const uint32_t iThread,
+                                    const uint32_t iAmount)
+{
+    int aCpu;
+    tPerCpuCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tPerCpuCounter_instance *)ioInstancePtr;
+
+    aCpu = sched_getcpu();
+    if (aCpu < 0)
+    {
+        aCpu = 0;
+    }
+
+    atomic_fetch_add_explicit(&aCounterPtr->mShard[(uint32_t)aCpu % aCounterPtr->mShards].mCount,
+                              iAmount,
+                              memory_order_relaxed);
+}
+
+/**
+ * @brief Get counter value by summing every shard.
+ *
+ * @param ioInstancePtr Counter to read from.
+ * @param oCount Address to write count to.
+ */
+static void PerCpuCounter_get(tCounter_instance *ioInstancePtr,
+                              uint32_t *oCount)
+{
+    uint32_t aShard;
+    uint32_t aCount;
+    tPerCpuCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tPerCpuCounter_instance *)ioInstancePtr;
+
+    aCount = 0;
+    for (aShard = 0; aShard < aCounterPtr->mShards; ++aShard)
+    {
+        aCount += atomic_load_explicit(&aCounterPtr->mShard[aShard].mCount, memory_order_relaxed);
+    }
+    atomic_thread_fence(memory_order_acquire);
+
+    *oCount = aCount;
+}
+
+const tCounter_interface gPerCpuCounter_interface =
+    {
+        PerCpuCounter_create,
+        PerCpuCounter_destroy,
+        PerCpuCounter_reset,
+        PerCpuCounter_flush,
+        PerCpuCounter_increment,
+        PerCpuCounter_get};
@@ -0,0 +1,293 @@
+#include <ProbabilisticCounter.h>
+#include <assert.h>
+#include <counter_platform.h>
+#include <math.h>
+#include <memory.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * @brief Morris counter.
+ *
+ * The level's increment probability and count estimate are computed from c
+ * when needed rather than tabulated: at small error the tables would hold
+ * tens of thousands of levels. The level changes rarely, so mLevel shares
+ * its line with the read-only fields.
+ */
+typedef struct
+{
+    tCounter_instance mBase; // base class (must be first field)
+    _Atomic uint32_t mLevel; // current level c
+    uint32_t mLevels;        // levels to cover the uint32_t range; the last one saturates
+    double mGrowth;          // growth base a of the levels
+    double mLogGrowth;       // ln(a)
+} tProbabilisticCounter_instance;
+
+/**
+ * @brief A thread's last computed draw threshold, so an increment only
+ *        evaluates exp() when the level (or the counter) changed.
+ */
+typedef struct
+{
+    const tProbabilisticCounter_instance *mCounterPtr; // counter the threshold belongs to
+    double mGrowth;                                    // its growth base (the address may be reused)
+    uint32_t mLevel;                                   // level the threshold belongs to
+    uint64_t mThreshold;                               // level c is raised when a draw is below this
+} tProbabilisticCounter_cache;
+
+/**
+ * @brief Per-thread xorshift64* state. Zero until first use.
+ */
+static _Thread_local uint64_t sProbabilisticCounter_rng;
+
+/**
+ * @brief Seeds handed out so far; keeps threads seeded in the same
+ *        nanosecond apart.
+ */
+static _Atomic uint64_t sProbabilisticCounter_seeds;
+
+/**
+ * @brief Per-thread draw threshold cache.
+ */
+static _Thread_local tProbabilisticCounter_cache sProbabilisticCounter_cache;
+
+/**
+ * @brief Draw a uniformly distributed 64-bit random number.
+ */
+static inline uint64_t ProbabilisticCounter_random(void)
+{
+    uint64_t aState;
+    struct timespec aNow;
+
+    aState = sProbabilisticCounter_rng;
+    if (aState == 0)
+    {
+        // seed from the clock in ns and a process-wide sequence number
+        clock_gettime(CLOCK_REALTIME, &aNow);
+        aState = (uint64_t)aNow.tv_sec * 1000000000ull + (uint64_t)aNow.tv_nsec;
+        aState ^= atomic_fetch_add_explicit(&sProbabilisticCounter_seeds, 1, memory_order_relaxed) * 0x9E3779B97F4A7C15ull;
+        aState = Counter_hash64(aState) | 1;
+    }
+    aState ^= aState >> 12;
+    aState ^= aState << 25;
+    aState ^= aState >> 27;
+    sProbabilisticCounter_rng = aState;
+    return aState * 0x2545F4914F6CDD1Dull;
+}
+
+/**
+ * @brief Draw threshold a^-c * 2^64 of a level (0 once saturated).
+ */
+static inline uint64_t ProbabilisticCounter_threshold(const tProbabilisticCounter_instance *iCounterPtr,
+                                                      const uint32_t iLevel)
+{
+    tProbabilisticCounter_cache *aCachePtr;
+
+    aCachePtr = &sProbabilisticCounter_cache;
+    if (aCachePtr->mCounterPtr != iCounterPtr || aCachePtr->mLevel != iLevel ||
+        aCachePtr->mGrowth != iCounterPtr->mGrowth)
+    {
+        aCachePtr->mCounterPtr = iCounterPtr;
+        aCachePtr->mGrowth = iCounterPtr->mGrowth;
+        aCachePtr->mLevel = iLevel;
+        if (iLevel == 0)
+        {
+            aCachePtr->mThreshold = UINT64_MAX;
+        }
+        else if (iLevel >= iCounterPtr->mLevels - 1)
+        {
+            aCachePtr->mThreshold = 0;
+        }
+        else
+        {
+            aCachePtr->mThreshold = (uint64_t)ldexp(exp(-(double)iLevel * iCounterPtr->mLogGrowth), 64);
+        }
+    }
+    return aCachePtr->mThreshold;
+}
+
+/**
+ * @brief Allocate and initialize the probabilistic counter.
+ *
+ * @param iBasePtr Counter base to initialize.
+ * @param iOptionsPtr Pointer to tProbabilisticCounter_options, or NULL for a
+ *                    2% relative error.
+ * @return Pointer to new counter instance.
+ */
+static tCounter_instance *ProbabilisticCounter_create(const tCounter_instance *iBasePtr, const void *iOptionsPtr)
+{
+    double aGrowth;
+    double aError;
+    const tProbabilisticCounter_options *aOptionsPtr;
+    tProbabilisticCounter_instance *aCounterPtr;
+
+    assert(iBasePtr != NULL); // required parameter
+
+    // get options
+    aGrowth = 0.0;
+    aError = 0.02;
+    if (iOptionsPtr != NULL)
+    {
+        aOptionsPtr = (const tProbabilisticCounter_options *)iOptionsPtr;
+        aGrowth = aOptionsPtr->mBase;
+        aError = aOptionsPtr->mRelativeError;
+    }
+    if (aGrowth <= 1.0)
+    {
+        // invert the error sqrt((a - 1) / 2)
+        assert(aError > 0.0);
+        aGrowth = 1.0 + 2.0 * aError * aError;
+    }
+
+    // allocate probabilistic counter instance
+    aCounterPtr = malloc(sizeof(tProbabilisticCounter_instance));
+    assert(aCounterPtr != NULL);
+    memset(aCounterPtr, 0, sizeof(tProbabilisticCounter_instance)); // blank slate
+
+    // copy the base into the instance
+    memcpy(aCounterPtr, iBasePtr, sizeof(tCounter_instance));
+
+    // initialize counter state
+    aCounterPtr->mGrowth = aGrowth;
+    aCounterPtr->mLogGrowth = log(aGrowth);
+    atomic_init(&aCounterPtr->mLevel, 0);
+
+    // number of levels needed for the estimate to cover the uint32_t range
+    aCounterPtr->mLevels = (uint32_t)ceil(log(UINT32_MAX * (aGrowth - 1.0) + 1.0) / aCounterPtr->mLogGrowth) + 1;
+
+    return (tCounter_instance *)aCounterPtr;
+}
+
+/**
+ * @brief Clean up counter resources. Free all memory allocated in _create.
+ *
+ * @param ioInstancePtr Counter instance to destroy.
+ */
+static void ProbabilisticCounter_destroy(tCounter_instance *ioInstancePtr)
+{
+    free(ioInstancePtr);
+}
+
+/**
+ * @brief Reset counter to zero.
+ *
+ * @param ioInstancePtr Counter to reset.
+ */
+static void ProbabilisticCounter_reset(tCounter_instance *ioInstancePtr)
+{
+    tProbabilisticCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tProbabilisticCounter_instance *)ioInstancePtr;
+
+    atomic_store_explicit(&aCounterPtr->mLevel, 0, memory_order_release);
+}
+
+/**
+ * @brief Flush pending updates.
+ *
+ * No-op for probabilistic counter (there is no local state).
+ *
+ * @param ioInstancePtr Counter instance.
+ * @param iThread Ignored.
+ */
+static void ProbabilisticCounter_flush(tCounter_instance *ioInstancePtr, const uint32_t iThread)
+{
+    // Do nothing - successful trials are applied immediately
+}
+
+/**
+ * @brief Run one increment trial per unit of iAmount.
+ *
+ * A failed trial touches no shared memory. A successful one raises the level
+ * with a CAS; if another thread raised it first, the trial is redrawn against
+ * the new level's probability.
+ *
+ * @param ioInstancePtr Counter to update.
+ * @param iThread Ignored (for API compatibility).
+ * @param iAmount Amount to add to counter.
+ */
+static void ProbabilisticCounter_increment(tCounter_instance *ioInstancePtr,
+                                           const uint32_t iThread,
+                                           const uint32_t iAmount)
+{
+    uint32_t aUnit;
+    uint32_t aLevel;
+    tProbabilisticCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tProbabilisticCounter_instance *)ioInstancePtr;
+
+    aLevel = atomic_load_explicit(&aCounterPtr->mLevel, memory_order_relaxed);
+    for (aUnit = 0; aUnit < iAmount; ++aUnit)
+    {
+        while (ProbabilisticCounter_random() < ProbabilisticCounter_threshold(aCounterPtr, aLevel))
+        {
+            if (atomic_compare_exchange_strong_explicit(&aCounterPtr->mLevel,
+                                                        &aLevel,
+                                                        aLevel + 1,
+                                                        memory_order_relaxed,
+                                                        memory_order_relaxed))
+            {
+                ++aLevel;
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Get the count estimate of the current level.
+ *
+ * @param ioInstancePtr Counter to read from.
+ * @param oCount Address to write count to.
+ */
+static void ProbabilisticCounter_get(tCounter_instance *ioInstancePtr,
+                                     uint32_t *oCount)
+{
+    double aEstimate;
+    tProbabilisticCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tProbabilisticCounter_instance *)ioInstancePtr;
+
+    // (a^c - 1) / (a - 1), with expm1 keeping precision for a close to 1
+    aEstimate = expm1((double)atomic_load_explicit(&aCounterPtr->mLevel, memory_order_acquire) *
+                      aCounterPtr->mLogGrowth) /
+                (aCounterPtr->mGrowth - 1.0);
+    *oCount = (aEstimate >= (double)UINT32_MAX) ? UINT32_MAX : (uint32_t)llround(aEstimate);
+}
+
+double ProbabilisticCounter_relativeError(const tCounter_instance *iInstancePtr)
+{
+    const tProbabilisticCounter_instance *aCounterPtr;
+
+    assert(iInstancePtr != NULL);
+
+    aCounterPtr = (const tProbabilisticCounter_instance *)iInstancePtr;
+
+    return sqrt((aCounterPtr->mGrowth - 1.0) / 2.0);
+}
+
+const tCounter_interface gProbabilisticCounter_interface =
+    {
+        ProbabilisticCounter_create,
+        ProbabilisticCounter_destroy,
+        ProbabilisticCounter_reset,
+        ProbabilisticCounter_flush,
+        ProbabilisticCounter_increment,
+        ProbabilisticCounter_get};
@@ -0,0 +1,215 @@
+#include <RateLimiter.h>
+#include <assert.h>
+#include <counter_platform.h>
+#include <memory.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define kRateLimiter_fracBits 8 // time is kept in 1/256 ns, so token intervals round by < 1/256 ns
+
+/**
+ * @brief Per-thread local bucket, one cache line each. Only the owner
+ *        touches it.
+ */
+typedef struct
+{
+    alignas(kCounter_cacheLineSize) uint32_t mTokens; // leased tokens left
+} tRateLimiter_local;
+
+struct __tRateLimiter
+{
+    uint32_t mThreads;           // number of local buckets
+    uint32_t mChunk;             // lease size
+    uint64_t mInterval;          // time to refill one token, rounded up
+    uint64_t mBurst;             // time to refill the whole bucket
+    uint64_t mEpochNs;           // CLOCK_MONOTONIC time at the last reset
+    tRateLimiter_local *mLocals; // per-thread buckets
+
+    // Time at which the global bucket would be full again if nothing else
+    // were taken; tokens available at time t: (t + mBurst - mTat) / mInterval
+    alignas(kCounter_cacheLineSize) _Atomic uint64_t mTat;
+};
+
+/**
+ * @brief Current CLOCK_MONOTONIC time in nanoseconds.
+ */
+static inline uint64_t RateLimiter_nowNs(void)
+{
+    struct timespec aTimeSpec;
+    clock_gettime(CLOCK_MONOTONIC, &aTimeSpec);
+    return (uint64_t)aTimeSpec.tv_sec * 1000000000u + (uint64_t)aTimeSpec.tv_nsec;
+}
+
+/**
+ * @brief Current limiter time: 1/256 ns since the last reset, offset by one
+ *        burst so that "now - burst" never goes below zero. 56 bits of
+ *        nanoseconds last over two years between resets.
+ */
+static inline uint64_t RateLimiter_now(const tRateLimiter *iLimiterPtr)
+{
+    return ((RateLimiter_nowNs() - iLimiterPtr->mEpochNs) << kRateLimiter_fracBits) + iLimiterPtr->mBurst;
+}
+
+/**
+ * @brief Take up to iWanted tokens from the global bucket.
+ *
+ * @return Number of tokens taken (0 if the bucket is empty).
+ */
+static uint32_t RateLimiter_lease(tRateLimiter *ioLimiterPtr, const uint32_t iWanted)
+{
+    uint64_t aNow;
+    uint64_t aTat;
+    uint64_t aBase;
+    uint64_t aAvailable;
+    uint32_t aTaken;
+
+    aNow = RateLimiter_now(ioLimiterPtr);
+    aTat = atomic_load_explicit(&ioLimiterPtr->mTat, memory_order_relaxed);
+    for (;;)
+    {
+        // the bucket can not hold more than a burst, so refill stops at aNow;
+        // a thread with a later clock reading may have pushed mTat past our
+        // window already
+        aBase = (aTat > aNow) ? aTat : aNow;
+        if (aBase >= aNow + ioLimiterPtr->mBurst)
+        {
+            return 0;
+        }
+        aAvailable = (aNow + ioLimiterPtr->mBurst - aBase) / ioLimiterPtr->mInterval;
+        if (aAvailable == 0)
+        {
+            return 0;
+        }
+
+        aTaken = (aAvailable < iWanted) ? (uint32_t)aAvailable : iWanted;
+        if (atomic_compare_exchange_weak_explicit(&ioLimiterPtr->mTat, &aTat,
+                                                  aBase + aTaken * ioLimiterPtr->mInterval,
+                                                  memory_order_relaxed, memory_order_relaxed))
+        {
+            return aTaken;
+        }
+    }
+}
+
+tRateLimiter *RateLimiter_create(const tRateLimiter_options *iOptionsPtr)
+{
+    tRateLimiter *aLimiterPtr;
+
+    assert(iOptionsPtr != NULL);      // required parameter
+    assert(iOptionsPtr->mThreads);    // need at least one local bucket
+    assert(iOptionsPtr->mRatePerSec); // a zero rate never refills
+
+    aLimiterPtr = aligned_alloc(kCounter_cacheLineSize, sizeof(tRateLimiter));
+    assert(aLimiterPtr != NULL);
+    memset(aLimiterPtr, 0, sizeof(tRateLimiter)); // blank slate
+
+    aLimiterPtr->mThreads = iOptionsPtr->mThreads;
+    aLimiterPtr->mChunk = (iOptionsPtr->mChunk != 0) ? iOptionsPtr->mChunk : 1;
+    // round the interval up so the effective rate never exceeds the
+    // configured one; the fraction bits keep the shortfall below 0.4% up to
+    // 1e9 tokens/s
+    aLimiterPtr->mInterval = ((1000000000ull << kRateLimiter_fracBits) + iOptionsPtr->mRatePerSec - 1) /
+                             iOptionsPtr->mRatePerSec;
+    aLimiterPtr->mBurst = (uint64_t)((iOptionsPtr->mBurst != 0) ? iOptionsPtr->mBurst : 1) * aLimiterPtr->mInterval;
+
+    aLimiterPtr->mLocals = aligned_alloc(kCounter_cacheLineSize, aLimiterPtr->mThreads * sizeof(tRateLimiter_local));
+    assert(aLimiterPtr->mLocals != NULL);
+
+    RateLimiter_reset(aLimiterPtr);
+
+    return aLimiterPtr;
+}
+
+void RateLimiter_destroy(tRateLimiter *ioLimiterPtr)
+{
+    if (ioLimiterPtr == NULL)
+    {
+        return;
+    }
+
+    free(ioLimiterPtr->mLocals);
+    free(ioLimiterPtr);
+}
+
+void RateLimiter_reset(tRateLimiter *ioLimiterPtr)
+{
+    uint32_t aThread;
+
+    if (ioLimiterPtr == NULL)
+    {
+        return;
+    }
+
+    for (aThread = 0; aThread < ioLimiterPtr->mThreads; ++aThread)
+    {
+        ioLimiterPtr->mLocals[aThread].mTokens = 0;
+    }
+    ioLimiterPtr->mEpochNs = RateLimiter_nowNs();
+    atomic_store_explicit(&ioLimiterPtr->mTat, RateLimiter_now(ioLimiterPtr), memory_order_relaxed); // full bucket
+}
+
+void RateLimiter_flush(tRateLimiter *ioLimiterPtr, const uint32_t iThread)
+{
+    uint32_t aTokens;
+    uint64_t aGive;
+    uint64_t aFloor;
+    uint64_t aTat;
+    uint64_t aNewTat;
+
+    if (ioLimiterPtr == NULL)
+    {
+        return;
+    }
+
+    assert(iThread < ioLimiterPtr->mThreads);
+
+    aTokens = ioLimiterPtr->mLocals[iThread].mTokens;
+    if (aTokens != 0)
+    {
+        ioLimiterPtr->mLocals[iThread].mTokens = 0;
+        // moving the arrival time back gives the tokens back, but never
+        // further than a full bucket at now - burst
+        aGive = aTokens * ioLimiterPtr->mInterval;
+        aFloor = RateLimiter_now(ioLimiterPtr) - ioLimiterPtr->mBurst;
+        aTat = atomic_load_explicit(&ioLimiterPtr->mTat, memory_order_relaxed);
+        do
+        {
+            aNewTat = (aTat > aFloor + aGive) ? aTat - aGive : aFloor;
+            if (aNewTat >= aTat)
+            {
+                return; // already full
+            }
+        } while (!atomic_compare_exchange_weak_explicit(&ioLimiterPtr->mTat, &aTat, aNewTat,
+                                                        memory_order_relaxed, memory_order_relaxed));
+    }
+}
+
+bool RateLimiter_tryAcquire(tRateLimiter *ioLimiterPtr, const uint32_t iThread)
+{
+    tRateLimiter_local *aLocalPtr;
+
+    assert(iThread < ioLimiterPtr->mThreads);
+    aLocalPtr = &ioLimiterPtr->mLocals[iThread];
+
+    if (aLocalPtr->mTokens == 0)
+    {
+        // local bucket empty: lease the next chunk, spending one of it now
+        aLocalPtr->mTokens = RateLimiter_lease(ioLimiterPtr, ioLimiterPtr->mChunk);
+        if (aLocalPtr->mTokens == 0)
+        {
+            return false;
+        }
+    }
+
+    --aLocalPtr->mTokens;
+    return true;
+}
+
+uint64_t RateLimiter_overshootBound(const tRateLimiter *iLimiterPtr)
+{
+    return (uint64_t)iLimiterPtr->mThreads * (iLimiterPtr->mChunk - 1);
+}
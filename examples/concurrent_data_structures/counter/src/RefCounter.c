@@ -0,0 +1,199 @@
+#include <RefCounter.h>
+#include <assert.h>
+#include <counter_platform.h>
+#include <memory.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * Slot values are biased by kRefCounter_slotBias so that a thread's net count
+ * (negative when it drops references others took) never sets the top bit.
+ * Kill swaps kRefCounter_deadSlot into each slot, which is just as far from
+ * the top-bit boundaries; an owner that sees the top bit come back from its
+ * fetch_add knows its slot was flushed and uses the atomic count.
+ * mCount carries kRefCounter_liveBias until kill, so it can not hit zero while
+ * slots still hold references.
+ */
+#define kRefCounter_dead ((uint64_t)1 << 63)
+#define kRefCounter_slotBias ((uint64_t)1 << 62)
+#define kRefCounter_deadSlot (kRefCounter_dead + kRefCounter_slotBias)
+#define kRefCounter_liveBias ((uint64_t)1 << 62)
+
+/**
+ * @brief Per-thread slot, one cache line each.
+ *
+ * Same shape as ApproximateCounter's padded slot, but not shared with it:
+ * these are 64-bit, biased, and updated with fetch_add so that kill can drain
+ * them while their owners keep running.
+ */
+typedef struct
+{
+    alignas(kCounter_cacheLineSize) _Atomic uint64_t mLocal; // biased net count, or dead
+} tRefCounter_slot;
+
+struct __tRefCounter
+{
+    alignas(kCounter_cacheLineSize) _Atomic uint64_t mCount; // biased while live, exact once killed
+    _Atomic bool mDying;                                     // kill has started
+    uint32_t mThreads;                                       // number of slots
+    tRefCounter_release *mReleasePtr;                        // zero callback
+    void *mContextPtr;                                       // zero callback argument
+    tRefCounter_slot *mSlots;                                // per-thread slots
+};
+
+/**
+ * @brief Atomic-mode drop: release the object when the count reaches zero.
+ */
+static void RefCounter_putAtomic(tRefCounter *ioRefPtr, const uint64_t iAmount)
+{
+    if (atomic_fetch_sub_explicit(&ioRefPtr->mCount, iAmount, memory_order_acq_rel) == iAmount &&
+        ioRefPtr->mReleasePtr != NULL)
+    {
+        ioRefPtr->mReleasePtr(ioRefPtr->mContextPtr);
+    }
+}
+
+tRefCounter *RefCounter_create(const tRefCounter_options *iOptionsPtr)
+{
+    uint32_t aThread;
+    tRefCounter *aRefPtr;
+
+    assert(iOptionsPtr != NULL);   // required parameter
+    assert(iOptionsPtr->mThreads); // need at least one slot
+
+    aRefPtr = aligned_alloc(kCounter_cacheLineSize, sizeof(tRefCounter));
+    assert(aRefPtr != NULL);
+    memset(aRefPtr, 0, sizeof(tRefCounter)); // blank slate
+
+    aRefPtr->mThreads = iOptionsPtr->mThreads;
+    aRefPtr->mReleasePtr = iOptionsPtr->mReleasePtr;
+    aRefPtr->mContextPtr = iOptionsPtr->mContextPtr;
+
+    aRefPtr->mSlots = aligned_alloc(kCounter_cacheLineSize, aRefPtr->mThreads * sizeof(tRefCounter_slot));
+    assert(aRefPtr->mSlots != NULL);
+    for (aThread = 0; aThread < aRefPtr->mThreads; ++aThread)
+    {
+        atomic_init(&aRefPtr->mSlots[aThread].mLocal, kRefCounter_slotBias);
+    }
+
+    atomic_init(&aRefPtr->mCount, kRefCounter_liveBias + 1); // initial reference
+    atomic_init(&aRefPtr->mDying, false);
+
+    return aRefPtr;
+}
+
+void RefCounter_destroy(tRefCounter *ioRefPtr)
+{
+    if (ioRefPtr == NULL)
+    {
+        return;
+    }
+
+    free(ioRefPtr->mSlots);
+    free(ioRefPtr);
+}
+
+void RefCounter_get(tRefCounter *ioRefPtr, const uint32_t iThread)
+{
+    assert(iThread < ioRefPtr->mThreads);
+
+    if (atomic_fetch_add_explicit(&ioRefPtr->mSlots[iThread].mLocal, 1, memory_order_relaxed) & kRefCounter_dead)
+    {
+        atomic_fetch_add_explicit(&ioRefPtr->mCount, 1, memory_order_relaxed);
+    }
+}
+
+bool RefCounter_tryGet(tRefCounter *ioRefPtr, const uint32_t iThread)
+{
+    uint64_t aCount;
+
+    assert(iThread < ioRefPtr->mThreads);
+
+    if ((atomic_fetch_add_explicit(&ioRefPtr->mSlots[iThread].mLocal, 1, memory_order_relaxed) & kRefCounter_dead) == 0)
+    {
+        return true; // live: the count can not be zero
+    }
+
+    // killed: increment unless zero (the dead slot's value is never read again)
+    aCount = atomic_load_explicit(&ioRefPtr->mCount, memory_order_relaxed);
+    while (aCount != 0)
+    {
+        if (atomic_compare_exchange_weak_explicit(&ioRefPtr->mCount, &aCount, aCount + 1,
+                                                  memory_order_acquire, memory_order_relaxed))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RefCounter_tryGetLive(tRefCounter *ioRefPtr, const uint32_t iThread)
+{
+    if (atomic_load_explicit(&ioRefPtr->mDying, memory_order_acquire))
+    {
+        return false;
+    }
+
+    RefCounter_get(ioRefPtr, iThread);
+    return true;
+}
+
+void RefCounter_put(tRefCounter *ioRefPtr, const uint32_t iThread)
+{
+    assert(iThread < ioRefPtr->mThreads);
+
+    // release: the owner's accesses to the object must precede the final drop
+    if (atomic_fetch_sub_explicit(&ioRefPtr->mSlots[iThread].mLocal, 1, memory_order_release) & kRefCounter_dead)
+    {
+        RefCounter_putAtomic(ioRefPtr, 1);
+    }
+}
+
+void RefCounter_kill(tRefCounter *ioRefPtr)
+{
+    uint32_t aThread;
+    uint64_t aSum;
+    bool aWasDying;
+
+    aWasDying = atomic_exchange_explicit(&ioRefPtr->mDying, true, memory_order_acq_rel);
+    assert(!aWasDying); // kill must be called exactly once
+    (void)aWasDying;
+
+    // flush every slot into the atomic count, marking it dead
+    aSum = 0;
+    for (aThread = 0; aThread < ioRefPtr->mThreads; ++aThread)
+    {
+        aSum += atomic_exchange_explicit(&ioRefPtr->mSlots[aThread].mLocal, kRefCounter_deadSlot, memory_order_acq_rel) -
+                kRefCounter_slotBias;
+    }
+    atomic_fetch_add_explicit(&ioRefPtr->mCount, aSum, memory_order_acq_rel);
+
+    // drop the live bias together with the initial reference
+    RefCounter_putAtomic(ioRefPtr, kRefCounter_liveBias + 1);
+}
+
+uint64_t RefCounter_count(tRefCounter *ioRefPtr)
+{
+    uint32_t aThread;
+    uint64_t aCount;
+    uint64_t aLocal;
+
+    aCount = atomic_load_explicit(&ioRefPtr->mCount, memory_order_acquire);
+    if (aCount >= kRefCounter_liveBias / 2)
+    {
+        // live (or being killed): add up the slots that are not yet flushed
+        aCount -= kRefCounter_liveBias;
+        for (aThread = 0; aThread < ioRefPtr->mThreads; ++aThread)
+        {
+            aLocal = atomic_load_explicit(&ioRefPtr->mSlots[aThread].mLocal, memory_order_relaxed);
+            if ((aLocal & kRefCounter_dead) == 0)
+            {
+                aCount += aLocal - kRefCounter_slotBias;
+            }
+        }
+    }
+    return aCount;
+}
@@ -0,0 +1,108 @@
+#include <SequenceAllocator.h>
+#include <assert.h>
+#include <counter_platform.h>
+#include <memory.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @brief Per-thread lease, one cache line each. Only the owner touches it.
+ */
+typedef struct
+{
+    alignas(kCounter_cacheLineSize) uint64_t mNext; // next value to hand out
+    uint64_t mEnd;                                  // end of the leased block (exclusive)
+} tSequenceAllocator_lease;
+
+struct __tSequenceAllocator
+{
+    uint32_t mThreads;                 // number of leases
+    uint32_t mBlockSize;               // values per lease
+    tSequenceAllocator_order mOrder;   // ordering mode
+    tSequenceAllocator_lease *mLeases; // per-thread leases
+
+    alignas(kCounter_cacheLineSize) _Atomic uint64_t mNext; // first value not yet leased
+};
+
+tSequenceAllocator *SequenceAllocator_create(const tSequenceAllocator_options *iOptionsPtr)
+{
+    tSequenceAllocator *aAllocatorPtr;
+
+    assert(iOptionsPtr != NULL);     // required parameter
+    assert(iOptionsPtr->mThreads);   // need at least one lease
+    assert(iOptionsPtr->mBlockSize); // empty leases never make progress
+
+    aAllocatorPtr = aligned_alloc(kCounter_cacheLineSize, sizeof(tSequenceAllocator));
+    assert(aAllocatorPtr != NULL);
+    memset(aAllocatorPtr, 0, sizeof(tSequenceAllocator)); // blank slate
+
+    aAllocatorPtr->mThreads = iOptionsPtr->mThreads;
+    aAllocatorPtr->mBlockSize = iOptionsPtr->mBlockSize;
+    aAllocatorPtr->mOrder = iOptionsPtr->mOrder;
+
+    aAllocatorPtr->mLeases = aligned_alloc(kCounter_cacheLineSize,
+                                           aAllocatorPtr->mThreads * sizeof(tSequenceAllocator_lease));
+    assert(aAllocatorPtr->mLeases != NULL);
+
+    SequenceAllocator_reset(aAllocatorPtr);
+
+    return aAllocatorPtr;
+}
+
+void SequenceAllocator_destroy(tSequenceAllocator *ioAllocatorPtr)
+{
+    if (ioAllocatorPtr == NULL)
+    {
+        return;
+    }
+
+    free(ioAllocatorPtr->mLeases);
+    free(ioAllocatorPtr);
+}
+
+void SequenceAllocator_reset(tSequenceAllocator *ioAllocatorPtr)
+{
+    uint32_t aThread;
+
+    if (ioAllocatorPtr == NULL)
+    {
+        return;
+    }
+
+    for (aThread = 0; aThread < ioAllocatorPtr->mThreads; ++aThread)
+    {
+        ioAllocatorPtr->mLeases[aThread].mNext = 0;
+        ioAllocatorPtr->mLeases[aThread].mEnd = 0; // empty: lease on first use
+    }
+    atomic_store_explicit(&ioAllocatorPtr->mNext, 0, memory_order_release);
+}
+
+uint64_t SequenceAllocator_next(tSequenceAllocator *ioAllocatorPtr, const uint32_t iThread)
+{
+    tSequenceAllocator_lease *aLeasePtr;
+
+    assert(iThread < ioAllocatorPtr->mThreads);
+
+    if (ioAllocatorPtr->mOrder == kSequenceAllocator_orderGlobal)
+    {
+        return atomic_fetch_add_explicit(&ioAllocatorPtr->mNext, 1, memory_order_relaxed);
+    }
+
+    aLeasePtr = &ioAllocatorPtr->mLeases[iThread];
+    if (aLeasePtr->mNext == aLeasePtr->mEnd)
+    {
+        // lease exhausted: take the next block in one shared operation
+        aLeasePtr->mNext = atomic_fetch_add_explicit(&ioAllocatorPtr->mNext,
+                                                     ioAllocatorPtr->mBlockSize,
+                                                     memory_order_relaxed);
+        aLeasePtr->mEnd = aLeasePtr->mNext + ioAllocatorPtr->mBlockSize;
+    }
+    return aLeasePtr->mNext++;
+}
+
+uint64_t SequenceAllocator_leased(tSequenceAllocator *ioAllocatorPtr)
+{
+    return atomic_load_explicit(&ioAllocatorPtr->mNext, memory_order_acquire);
+}
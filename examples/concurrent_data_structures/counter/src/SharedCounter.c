@@ -0,0 +1,293 @@
+#include <SharedCounter.h>
+#include <assert.h>
+#include <counter_platform.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <memory.h>
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define kSharedCounter_magic 0x53484d434f554e54ull // "SHMCOUNT", set once the segment is initialized
+
+/**
+ * @brief Header at the start of every shared segment. The count rows follow
+ *        it, each padded to whole cache lines.
+ */
+typedef struct
+{
+    alignas(kCounter_cacheLineSize) _Atomic uint64_t mMagic; // kSharedCounter_magic once initialized
+    uint32_t mWorkers;                                       // number of workers
+    uint32_t mCounters;                                      // counters per row
+    uint32_t mMode;                                          // tSharedCounter_mode
+    uint32_t mRows;                                          // number of count rows
+    uint64_t mRowStride;                                     // counts between rows (whole cache lines)
+    uint64_t mBytes;                                         // size of the segment
+    pthread_mutex_t mLock;                                   // process-shared, guards the row in locked mode
+} tSharedCounter_segment;
+
+struct __tSharedCounter
+{
+    tSharedCounter_segment *mSegmentPtr; // mapping of the segment in this process
+    _Atomic uint64_t *mRowsPtr;          // first count row, just past the header
+    char *mNamePtr;                      // shm_open name, NULL if anonymous or opened
+};
+
+/**
+ * @brief Allocate a process-private handle on a mapped segment.
+ */
+static tSharedCounter *SharedCounter_handle(tSharedCounter_segment *iSegmentPtr)
+{
+    tSharedCounter *aCounterPtr;
+
+    aCounterPtr = malloc(sizeof(tSharedCounter));
+    assert(aCounterPtr != NULL);
+    memset(aCounterPtr, 0, sizeof(tSharedCounter)); // blank slate
+
+    aCounterPtr->mSegmentPtr = iSegmentPtr;
+    aCounterPtr->mRowsPtr = (_Atomic uint64_t *)((char *)iSegmentPtr + Counter_cacheLineRound(sizeof(tSharedCounter_segment)));
+
+    return aCounterPtr;
+}
+
+tSharedCounter *SharedCounter_create(const tSharedCounter_options *iOptionsPtr)
+{
+    int aFd;
+    int aStatusCode;
+    uint32_t aRows;
+    size_t aRowStride;
+    size_t aBytes;
+    void *aMapPtr;
+    tSharedCounter_segment *aSegmentPtr;
+    tSharedCounter *aCounterPtr;
+    pthread_mutexattr_t aLockAttr;
+
+    assert(iOptionsPtr != NULL);    // required parameter
+    assert(iOptionsPtr->mWorkers);  // need at least one worker
+    assert(iOptionsPtr->mCounters); // need at least one counter
+    assert(iOptionsPtr->mMode <= kSharedCounter_modeLocked);
+
+    // size the segment: header, then one row per worker or a single shared row
+    aRows = (iOptionsPtr->mMode == kSharedCounter_modeSharded) ? iOptionsPtr->mWorkers : 1;
+    aRowStride = Counter_cacheLineRound(iOptionsPtr->mCounters * sizeof(uint64_t)) / sizeof(uint64_t);
+    aBytes = Counter_cacheLineRound(sizeof(tSharedCounter_segment)) + aRows * aRowStride * sizeof(uint64_t);
+
+    // map it; fresh shared memory reads zero
+    if (iOptionsPtr->mNamePtr == NULL)
+    {
+        aMapPtr = mmap(NULL, aBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    }
+    else
+    {
+        aFd = shm_open(iOptionsPtr->mNamePtr, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (aFd < 0)
+        {
+            return NULL;
+        }
+        if (ftruncate(aFd, (off_t)aBytes) != 0)
+        {
+            close(aFd);
+            shm_unlink(iOptionsPtr->mNamePtr);
+            return NULL;
+        }
+        aMapPtr = mmap(NULL, aBytes, PROT_READ | PROT_WRITE, MAP_SHARED, aFd, 0);
+        close(aFd); // the mapping keeps the segment alive
+        if (aMapPtr == MAP_FAILED)
+        {
+            shm_unlink(iOptionsPtr->mNamePtr);
+        }
+    }
+    if (aMapPtr == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    aSegmentPtr = (tSharedCounter_segment *)aMapPtr;
+    aSegmentPtr->mWorkers = iOptionsPtr->mWorkers;
+    aSegmentPtr->mCounters = iOptionsPtr->mCounters;
+    aSegmentPtr->mMode = iOptionsPtr->mMode;
+    aSegmentPtr->mRows = aRows;
+    aSegmentPtr->mRowStride = aRowStride;
+    aSegmentPtr->mBytes = aBytes;
+
+    // a robust mutex is handed to the next locker if its owner dies
+    aStatusCode = pthread_mutexattr_init(&aLockAttr);
+    assert(aStatusCode == 0);
+    aStatusCode = pthread_mutexattr_setpshared(&aLockAttr, PTHREAD_PROCESS_SHARED);
+    assert(aStatusCode == 0);
+    aStatusCode = pthread_mutexattr_setrobust(&aLockAttr, PTHREAD_MUTEX_ROBUST);
+    assert(aStatusCode == 0);
+    aStatusCode = pthread_mutex_init(&aSegmentPtr->mLock, &aLockAttr);
+    assert(aStatusCode == 0);
+    pthread_mutexattr_destroy(&aLockAttr);
+
+    aCounterPtr = SharedCounter_handle(aSegmentPtr);
+    if (iOptionsPtr->mNamePtr != NULL)
+    {
+        aCounterPtr->mNamePtr = strdup(iOptionsPtr->mNamePtr);
+        assert(aCounterPtr->mNamePtr != NULL);
+    }
+
+    // publish the initialized header to processes attaching by name
+    atomic_store_explicit(&aSegmentPtr->mMagic, kSharedCounter_magic, memory_order_release);
+
+    return aCounterPtr;
+}
+
+tSharedCounter *SharedCounter_open(const char *iNamePtr)
+{
+    int aFd;
+    size_t aBytes;
+    void *aMapPtr;
+    struct stat aStat;
+    tSharedCounter_segment *aSegmentPtr;
+
+    assert(iNamePtr != NULL); // required parameter
+
+    aFd = shm_open(iNamePtr, O_RDWR, 0);
+    if (aFd < 0)
+    {
+        return NULL;
+    }
+    if (fstat(aFd, &aStat) != 0 || (size_t)aStat.st_size < sizeof(tSharedCounter_segment))
+    {
+        close(aFd);
+        return NULL; // creator has not sized it yet
+    }
+    aBytes = (size_t)aStat.st_size;
+    aMapPtr = mmap(NULL, aBytes, PROT_READ | PROT_WRITE, MAP_SHARED, aFd, 0);
+    close(aFd);
+    if (aMapPtr == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    aSegmentPtr = (tSharedCounter_segment *)aMapPtr;
+    if (atomic_load_explicit(&aSegmentPtr->mMagic, memory_order_acquire) != kSharedCounter_magic ||
+        aSegmentPtr->mBytes != aBytes)
+    {
+        munmap(aMapPtr, aBytes);
+        return NULL; // creator has not initialized it yet
+    }
+
+    return SharedCounter_handle(aSegmentPtr);
+}
+
+void SharedCounter_close(tSharedCounter *ioCounterPtr)
+{
+    if (ioCounterPtr == NULL)
+    {
+        return;
+    }
+
+    munmap(ioCounterPtr->mSegmentPtr, ioCounterPtr->mSegmentPtr->mBytes);
+    free(ioCounterPtr->mNamePtr);
+    free(ioCounterPtr);
+}
+
+void SharedCounter_destroy(tSharedCounter *ioCounterPtr)
+{
+    if (ioCounterPtr == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_destroy(&ioCounterPtr->mSegmentPtr->mLock);
+    if (ioCounterPtr->mNamePtr != NULL)
+    {
+        shm_unlink(ioCounterPtr->mNamePtr);
+    }
+    SharedCounter_close(ioCounterPtr);
+}
+
+void SharedCounter_reset(tSharedCounter *ioCounterPtr)
+{
+    size_t aCount;
+    tSharedCounter_segment *aSegmentPtr;
+
+    if (ioCounterPtr == NULL)
+    {
+        return;
+    }
+
+    aSegmentPtr = ioCounterPtr->mSegmentPtr;
+    for (aCount = 0; aCount < aSegmentPtr->mRows * aSegmentPtr->mRowStride; ++aCount)
+    {
+        atomic_store_explicit(&ioCounterPtr->mRowsPtr[aCount], 0, memory_order_relaxed);
+    }
+}
+
+void SharedCounter_add(tSharedCounter *ioCounterPtr,
+                       const uint32_t iWorker,
+                       const uint32_t iCounter,
+                       const uint32_t iAmount)
+{
+    _Atomic uint64_t *aCountPtr;
+    tSharedCounter_segment *aSegmentPtr;
+
+    if (ioCounterPtr == NULL)
+    {
+        return;
+    }
+
+    aSegmentPtr = ioCounterPtr->mSegmentPtr;
+    assert(iWorker < aSegmentPtr->mWorkers);
+    assert(iCounter < aSegmentPtr->mCounters);
+
+    switch (aSegmentPtr->mMode)
+    {
+    case kSharedCounter_modeSharded:
+        // a worker's row has no other writer, even across processes
+        aCountPtr = &ioCounterPtr->mRowsPtr[iWorker * aSegmentPtr->mRowStride + iCounter];
+        atomic_store_explicit(aCountPtr,
+                              atomic_load_explicit(aCountPtr, memory_order_relaxed) + iAmount,
+                              memory_order_relaxed);
+        break;
+    case kSharedCounter_modeAtomic:
+        atomic_fetch_add_explicit(&ioCounterPtr->mRowsPtr[iCounter], iAmount, memory_order_relaxed);
+        break;
+    default:
+        // the update is a single store, so a dead previous owner left the
+        // count either before or after its add; either way it is consistent
+        if (pthread_mutex_lock(&aSegmentPtr->mLock) == EOWNERDEAD)
+        {
+            pthread_mutex_consistent(&aSegmentPtr->mLock);
+        }
+        aCountPtr = &ioCounterPtr->mRowsPtr[iCounter];
+        atomic_store_explicit(aCountPtr,
+                              atomic_load_explicit(aCountPtr, memory_order_relaxed) + iAmount,
+                              memory_order_relaxed);
+        pthread_mutex_unlock(&aSegmentPtr->mLock);
+        break;
+    }
+}
+
+void SharedCounter_get(tSharedCounter *ioCounterPtr, const uint32_t iCounter, uint64_t *oCount)
+{
+    uint32_t aRow;
+    uint64_t aCount;
+    tSharedCounter_segment *aSegmentPtr;
+
+    if (ioCounterPtr == NULL)
+    {
+        return;
+    }
+
+    aSegmentPtr = ioCounterPtr->mSegmentPtr;
+    assert(iCounter < aSegmentPtr->mCounters);
+
+    // the locked row is also written with atomic stores, so it reads safely
+    // without the mutex
+    aCount = 0;
+    for (aRow = 0; aRow < aSegmentPtr->mRows; ++aRow)
+    {
+        aCount += atomic_load_explicit(&ioCounterPtr->mRowsPtr[aRow * aSegmentPtr->mRowStride + iCounter],
+                                       memory_order_relaxed);
+    }
+    *oCount = aCount;
+}
@@ -0,0 +1,200 @@
+#include <SummingCounter.h>
+#include <assert.h>
+#include <counter_platform.h>
+#include <memory.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @brief Per-thread slot, one cache line each.
+ */
+typedef struct
+{
+    alignas(kCounter_cacheLineSize) _Atomic uint32_t mLocal; // local count
+} tSummingCounter_slot;
+
+/**
+ * @brief Exact counter with no global accumulator. The count is the sum of
+ *        the per-thread slots.
+ */
+typedef struct
+{
+    tCounter_instance mBase;      // base class (must be first field)
+    uint32_t mThreads;            // number of local counter threads
+    tSummingCounter_slot *mSlots; // local counts (one per thread)
+} tSummingCounter_instance;
+
+/**
+ * @brief Allocate and initialize the summing counter.
+ *
+ * @param iBasePtr Counter base to initialize.
+ * @param iOptionsPtr Pointer to tSummingCounter_options, or NULL for defaults.
+ * @return Pointer to new counter instance.
+ */
+static tCounter_instance *SummingCounter_create(const tCounter_instance *iBasePtr, const void *iOptionsPtr)
+{
+    uint32_t aThread;
+    uint32_t aThreads;
+    const tSummingCounter_options *aOptionsPtr;
+    tSummingCounter_instance *aCounterPtr;
+
+    assert(iBasePtr != NULL); // required parameter
+
+    // get options
+    if (iOptionsPtr != NULL)
+    {
+        aOptionsPtr = (const tSummingCounter_options *)iOptionsPtr;
+        aThreads = aOptionsPtr->mThreads;
+    }
+    else
+    {
+        // use defaults
+        aThreads = 8;
+    }
+
+    // allocate summing counter instance
+    aCounterPtr = malloc(sizeof(tSummingCounter_instance));
+    assert(aCounterPtr != NULL);
+    memset(aCounterPtr, 0, sizeof(tSummingCounter_instance)); // blank slate
+
+    // copy the base into the instance
+    memcpy(aCounterPtr, iBasePtr, sizeof(tCounter_instance));
+
+    // allocate counter heap state
+    aCounterPtr->mThreads = aThreads;
+    aCounterPtr->mSlots = aligned_alloc(kCounter_cacheLineSize,
+                                        aThreads * sizeof(tSummingCounter_slot));
+    assert(aCounterPtr->mSlots != NULL);
+    for (aThread = 0; aThread < aThreads; ++aThread)
+    {
+        atomic_init(&aCounterPtr->mSlots[aThread].mLocal, 0);
+    }
+
+    return (tCounter_instance *)aCounterPtr;
+}
+
+/**
+ * @brief Clean up counter resources. Free all memory allocated in _create.
+ *
+ * @param ioInstancePtr Counter instance to destroy.
+ */
+static void SummingCounter_destroy(tCounter_instance *ioInstancePtr)
+{
+    tSummingCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tSummingCounter_instance *)ioInstancePtr;
+
+    free(aCounterPtr->mSlots);
+    free(aCounterPtr);
+}
+
+/**
+ * @brief Reset all slots to zero. Writers must be quiescent.
+ *
+ * @param ioInstancePtr Counter to reset.
+ */
+static void SummingCounter_reset(tCounter_instance *ioInstancePtr)
+{
+    uint32_t aThread;
+    tSummingCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tSummingCounter_instance *)ioInstancePtr;
+
+    for (aThread = 0; aThread < aCounterPtr->mThreads; ++aThread)
+    {
+        atomic_store_explicit(&aCounterPtr->mSlots[aThread].mLocal, 0, memory_order_relaxed);
+    }
+    atomic_thread_fence(memory_order_release);
+}
+
+/**
+ * @brief Flush pending updates.
+ *
+ * No-op for summing counter (readers aggregate the slots directly).
+ *
+ * @param ioInstancePtr Counter instance.
+ * @param iThread Ignored.
+ */
+static void SummingCounter_flush(tCounter_instance *ioInstancePtr, const uint32_t iThread)
+{
+    // Do nothing - there is no global count to flush into
+}
+
+/**
+ * @brief Add to the calling thread's slot.
+ *
+ * @param ioInstancePtr Counter to update.
+ * @param iThread Thread ID (0 to num_threads-1) of the caller.
+ * @param iAmount Amount to add to counter.
+ */
+static void SummingCounter_increment(tCounter_instance *ioInstancePtr,
+                                     const uint32_t iThread,
+                                     const uint32_t iAmount)
+{
+    _Atomic uint32_t *aLocal;
+    tSummingCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tSummingCounter_instance *)ioInstancePtr;
+    aLocal = &aCounterPtr->mSlots[iThread].mLocal;
+
+    // only the owner writes the slot, so a load and a store suffice
+    atomic_store_explicit(aLocal,
+                          atomic_load_explicit(aLocal, memory_order_relaxed) + iAmount,
+                          memory_order_relaxed);
+}
+
+/**
+ * @brief Get counter value by summing every thread's slot.
+ *
+ * @param ioInstancePtr Counter to read from.
+ * @param oCount Address to write count to.
+ */
+static void SummingCounter_get(tCounter_instance *ioInstancePtr,
+                               uint32_t *oCount)
+{
+    uint32_t aThread;
+    uint32_t aCount;
+    tSummingCounter_instance *aCounterPtr;
+
+    if (ioInstancePtr == NULL)
+    {
+        return;
+    }
+
+    aCounterPtr = (tSummingCounter_instance *)ioInstancePtr;
+
+    aCount = 0;
+    for (aThread = 0; aThread < aCounterPtr->mThreads; ++aThread)
+    {
+        aCount += atomic_load_explicit(&aCounterPtr->mSlots[aThread].mLocal, memory_order_relaxed);
+    }
+    atomic_thread_fence(memory_order_acquire);
+
+    *oCount = aCount;
+}
+
+const tCounter_interface gSummingCounter_interface =
+    {
+        SummingCounter_create,
+        SummingCounter_destroy,
+        SummingCounter_reset,
+        SummingCounter_flush,
+        SummingCounter_increment,
+        SummingCounter_get};
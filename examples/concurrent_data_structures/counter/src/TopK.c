@@ -0,0 +1,376 @@
+#include <TopK.h>
+#include <assert.h>
+#include <counter_platform.h>
+#include <memory.h>
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @brief Entry of a thread's local table. A count of zero marks a free
+ *        entry. Only the owner writes; queries read concurrently.
+ */
+typedef struct
+{
+    _Atomic uint64_t mKey;   // key
+    _Atomic uint64_t mCount; // exact count since the last merge
+} tTopK_localEntry;
+
+/**
+ * @brief Per-thread local table (open addressing, twice mLocalCapacity slots).
+ */
+typedef struct
+{
+    alignas(kCounter_cacheLineSize) uint32_t mUsed; // keys in the table
+    tTopK_localEntry *mEntries;                     // hash table
+    tTopK_entry *mExact;                            // flush scratch, mLocalCapacity entries
+} tTopK_local;
+
+struct __tTopK
+{
+    uint32_t mThreads;       // number of local tables
+    uint32_t mCapacity;      // global summary size
+    uint32_t mLocalCapacity; // keys per local table before merging
+    uint32_t mLocalMask;     // local hash table size - 1
+    tTopK_local *mLocals;    // per-thread tables
+
+    pthread_mutex_t mGlobalLock; // protects the global summary
+    tTopK_entry *mGlobal;        // global summary, unordered
+    uint32_t mGlobalUsed;        // entries in mGlobal
+};
+
+/**
+ * @brief qsort order: by key.
+ */
+static int TopK_byKey(const void *iLhsPtr, const void *iRhsPtr)
+{
+    const tTopK_entry *aLhsPtr = (const tTopK_entry *)iLhsPtr;
+    const tTopK_entry *aRhsPtr = (const tTopK_entry *)iRhsPtr;
+
+    return (aLhsPtr->mKey > aRhsPtr->mKey) - (aLhsPtr->mKey < aRhsPtr->mKey);
+}
+
+/**
+ * @brief qsort order: by count, highest first.
+ */
+static int TopK_byCount(const void *iLhsPtr, const void *iRhsPtr)
+{
+    const tTopK_entry *aLhsPtr = (const tTopK_entry *)iLhsPtr;
+    const tTopK_entry *aRhsPtr = (const tTopK_entry *)iRhsPtr;
+
+    return (aLhsPtr->mCount < aRhsPtr->mCount) - (aLhsPtr->mCount > aRhsPtr->mCount);
+}
+
+/**
+ * @brief Merge exact counts into a Space-Saving summary.
+ *
+ * Keys already in the summary add their count. When the summary is full, any
+ * key outside it may have been seen up to the summary's minimum count times,
+ * so a new key enters with that minimum added (and as its error). The
+ * heaviest iCapacity entries are kept.
+ *
+ * @param ioSummary Summary of *ioUsedPtr entries, with room for iCapacity +
+ *                  iNumExact entries.
+ * @param ioUsedPtr Entries in the summary, updated.
+ * @param iCapacity Entries kept after the merge.
+ * @param iExact Exact counts to merge (mError is ignored).
+ * @param iNumExact Number of exact counts.
+ */
+static void TopK_merge(tTopK_entry *ioSummary,
+                       uint32_t *ioUsedPtr,
+                       const uint32_t iCapacity,
+                       const tTopK_entry *iExact,
+                       const uint32_t iNumExact)
+{
+    uint32_t aEntry;
+    uint32_t aUsed;
+    uint32_t aOld;
+    uint64_t aFloor;
+
+    if (iNumExact == 0)
+    {
+        return;
+    }
+
+    // the bound for keys outside a full summary
+    aOld = *ioUsedPtr;
+    aFloor = 0;
+    if (aOld == iCapacity)
+    {
+        aFloor = UINT64_MAX;
+        for (aEntry = 0; aEntry < aOld; ++aEntry)
+        {
+            aFloor = (ioSummary[aEntry].mCount < aFloor) ? ioSummary[aEntry].mCount : aFloor;
+        }
+    }
+
+    // append the new counts as if they were all new keys, then fold duplicates
+    for (aEntry = 0; aEntry < iNumExact; ++aEntry)
+    {
+        ioSummary[aOld + aEntry].mKey = iExact[aEntry].mKey;
+        ioSummary[aOld + aEntry].mCount = iExact[aEntry].mCount + aFloor;
+        ioSummary[aOld + aEntry].mError = aFloor;
+    }
+    qsort(ioSummary, aOld + iNumExact, sizeof(tTopK_entry), TopK_byKey);
+
+    aUsed = 0;
+    for (aEntry = 0; aEntry < aOld + iNumExact; ++aEntry)
+    {
+        if (aUsed != 0 && ioSummary[aUsed - 1].mKey == ioSummary[aEntry].mKey)
+        {
+            // tracked key: its floor does not apply, keep the tracked error
+            // (the local table holds each key once, so at most two meet)
+            if (ioSummary[aUsed - 1].mError == aFloor && ioSummary[aEntry].mError != aFloor)
+            {
+                ioSummary[aUsed - 1].mError = ioSummary[aEntry].mError;
+            }
+            ioSummary[aUsed - 1].mCount += ioSummary[aEntry].mCount - aFloor;
+        }
+        else
+        {
+            ioSummary[aUsed++] = ioSummary[aEntry];
+        }
+    }
+
+    if (aUsed > iCapacity)
+    {
+        qsort(ioSummary, aUsed, sizeof(tTopK_entry), TopK_byCount);
+        aUsed = iCapacity;
+    }
+    *ioUsedPtr = aUsed;
+}
+
+/**
+ * @brief Copy a local table's keys into iExact.
+ *
+ * @return Number of keys copied.
+ */
+static uint32_t TopK_collect(const tTopK *iTopKPtr, tTopK_local *iLocalPtr, tTopK_entry *oExact)
+{
+    uint32_t aSlot;
+    uint32_t aFound;
+    uint64_t aCount;
+
+    aFound = 0;
+    for (aSlot = 0; aSlot <= iTopKPtr->mLocalMask; ++aSlot)
+    {
+        aCount = atomic_load_explicit(&iLocalPtr->mEntries[aSlot].mCount, memory_order_acquire);
+        if (aCount != 0)
+        {
+            oExact[aFound].mKey = atomic_load_explicit(&iLocalPtr->mEntries[aSlot].mKey, memory_order_relaxed);
+            oExact[aFound].mCount = aCount;
+            oExact[aFound].mError = 0;
+            ++aFound;
+        }
+    }
+    return aFound;
+}
+
+/**
+ * @brief Empty a local table. Called by its owner while holding mGlobalLock,
+ *        or while writers are quiescent.
+ */
+static void TopK_clear(const tTopK *iTopKPtr, tTopK_local *ioLocalPtr)
+{
+    uint32_t aSlot;
+
+    for (aSlot = 0; aSlot <= iTopKPtr->mLocalMask; ++aSlot)
+    {
+        atomic_store_explicit(&ioLocalPtr->mEntries[aSlot].mCount, 0, memory_order_relaxed);
+    }
+    ioLocalPtr->mUsed = 0;
+}
+
+tTopK *TopK_create(const tTopK_options *iOptionsPtr)
+{
+    uint32_t aStatusCode;
+    uint32_t aThread;
+    uint32_t aSlots;
+    tTopK *aTopKPtr;
+
+    assert(iOptionsPtr != NULL);   // required parameter
+    assert(iOptionsPtr->mThreads); // need at least one local table
+
+    aTopKPtr = malloc(sizeof(tTopK));
+    assert(aTopKPtr != NULL);
+    memset(aTopKPtr, 0, sizeof(tTopK)); // blank slate
+
+    aTopKPtr->mThreads = iOptionsPtr->mThreads;
+    aTopKPtr->mCapacity = (iOptionsPtr->mCapacity != 0) ? iOptionsPtr->mCapacity : 64;
+    aTopKPtr->mLocalCapacity = (iOptionsPtr->mLocalCapacity != 0) ? iOptionsPtr->mLocalCapacity
+                                                                  : aTopKPtr->mCapacity;
+
+    // local tables stay at most half full so probes stay short
+    aSlots = 1;
+    while (aSlots < 2 * aTopKPtr->mLocalCapacity)
+    {
+        aSlots <<= 1;
+    }
+    aTopKPtr->mLocalMask = aSlots - 1;
+
+    aTopKPtr->mLocals = aligned_alloc(kCounter_cacheLineSize, aTopKPtr->mThreads * sizeof(tTopK_local));
+    assert(aTopKPtr->mLocals != NULL);
+    for (aThread = 0; aThread < aTopKPtr->mThreads; ++aThread)
+    {
+        aTopKPtr->mLocals[aThread].mEntries = calloc(aSlots, sizeof(tTopK_localEntry));
+        assert(aTopKPtr->mLocals[aThread].mEntries != NULL);
+        aTopKPtr->mLocals[aThread].mExact = malloc(aTopKPtr->mLocalCapacity * sizeof(tTopK_entry));
+        assert(aTopKPtr->mLocals[aThread].mExact != NULL);
+    }
+
+    // room for a full summary plus one merge batch
+    aTopKPtr->mGlobal = malloc((aTopKPtr->mCapacity + aTopKPtr->mLocalCapacity) * sizeof(tTopK_entry));
+    assert(aTopKPtr->mGlobal != NULL);
+    aStatusCode = pthread_mutex_init(&aTopKPtr->mGlobalLock, NULL);
+    assert(aStatusCode == 0);
+
+    TopK_reset(aTopKPtr);
+
+    return aTopKPtr;
+}
+
+void TopK_destroy(tTopK *ioTopKPtr)
+{
+    uint32_t aThread;
+
+    if (ioTopKPtr == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_destroy(&ioTopKPtr->mGlobalLock);
+    free(ioTopKPtr->mGlobal);
+    for (aThread = 0; aThread < ioTopKPtr->mThreads; ++aThread)
+    {
+        free(ioTopKPtr->mLocals[aThread].mEntries);
+        free(ioTopKPtr->mLocals[aThread].mExact);
+    }
+    free(ioTopKPtr->mLocals);
+    free(ioTopKPtr);
+}
+
+void TopK_reset(tTopK *ioTopKPtr)
+{
+    uint32_t aThread;
+
+    if (ioTopKPtr == NULL)
+    {
+        return;
+    }
+
+    for (aThread = 0; aThread < ioTopKPtr->mThreads; ++aThread)
+    {
+        TopK_clear(ioTopKPtr, &ioTopKPtr->mLocals[aThread]);
+    }
+    pthread_mutex_lock(&ioTopKPtr->mGlobalLock);
+    ioTopKPtr->mGlobalUsed = 0;
+    pthread_mutex_unlock(&ioTopKPtr->mGlobalLock);
+}
+
+void TopK_flush(tTopK *ioTopKPtr, const uint32_t iThread)
+{
+    uint32_t aFound;
+    tTopK_local *aLocalPtr;
+
+    if (ioTopKPtr == NULL)
+    {
+        return;
+    }
+
+    assert(iThread < ioTopKPtr->mThreads);
+    aLocalPtr = &ioTopKPtr->mLocals[iThread];
+    if (aLocalPtr->mUsed == 0)
+    {
+        return;
+    }
+
+    aFound = TopK_collect(ioTopKPtr, aLocalPtr, aLocalPtr->mExact);
+
+    pthread_mutex_lock(&ioTopKPtr->mGlobalLock);
+    TopK_merge(ioTopKPtr->mGlobal, &ioTopKPtr->mGlobalUsed, ioTopKPtr->mCapacity, aLocalPtr->mExact, aFound);
+    TopK_clear(ioTopKPtr, aLocalPtr); // inside the lock so a query never misses or doubles these counts
+    pthread_mutex_unlock(&ioTopKPtr->mGlobalLock);
+}
+
+void TopK_add(tTopK *ioTopKPtr, const uint32_t iThread, const uint64_t iKey, const uint32_t iAmount)
+{
+    uint32_t aSlot;
+    uint64_t aCount;
+    tTopK_local *aLocalPtr;
+    tTopK_localEntry *aEntryPtr;
+
+    assert(iThread < ioTopKPtr->mThreads);
+
+    if (iAmount == 0)
+    {
+        return;
+    }
+
+    aLocalPtr = &ioTopKPtr->mLocals[iThread];
+
+    for (;;)
+    {
+        for (aSlot = (uint32_t)Counter_hash64(iKey) & ioTopKPtr->mLocalMask;; aSlot = (aSlot + 1) & ioTopKPtr->mLocalMask)
+        {
+            aEntryPtr = &aLocalPtr->mEntries[aSlot];
+            aCount = atomic_load_explicit(&aEntryPtr->mCount, memory_order_relaxed);
+            if (aCount == 0)
+            {
+                break; // key not in the table
+            }
+            if (atomic_load_explicit(&aEntryPtr->mKey, memory_order_relaxed) == iKey)
+            {
+                atomic_store_explicit(&aEntryPtr->mCount, aCount + iAmount, memory_order_relaxed);
+                return;
+            }
+        }
+
+        if (aLocalPtr->mUsed < ioTopKPtr->mLocalCapacity)
+        {
+            // key before count: a query that sees the count sees the key
+            atomic_store_explicit(&aEntryPtr->mKey, iKey, memory_order_relaxed);
+            atomic_store_explicit(&aEntryPtr->mCount, iAmount, memory_order_release);
+            ++aLocalPtr->mUsed;
+            return;
+        }
+
+        // table full: hand it to the global summary and start over
+        TopK_flush(ioTopKPtr, iThread);
+    }
+}
+
+uint32_t TopK_query(tTopK *ioTopKPtr, const uint32_t iK, tTopK_entry *oEntries)
+{
+    uint32_t aThread;
+    uint32_t aFound;
+    uint32_t aUsed;
+    tTopK_entry *aSummary;
+    tTopK_entry *aExact;
+
+    aSummary = malloc((ioTopKPtr->mCapacity + ioTopKPtr->mLocalCapacity) * sizeof(tTopK_entry));
+    assert(aSummary != NULL);
+    aExact = malloc(ioTopKPtr->mLocalCapacity * sizeof(tTopK_entry));
+    assert(aExact != NULL);
+
+    // flushes clear their table under the lock, so while holding it every
+    // count is either in the global summary or in a local table, not both
+    pthread_mutex_lock(&ioTopKPtr->mGlobalLock);
+    memcpy(aSummary, ioTopKPtr->mGlobal, ioTopKPtr->mGlobalUsed * sizeof(tTopK_entry));
+    aUsed = ioTopKPtr->mGlobalUsed;
+    for (aThread = 0; aThread < ioTopKPtr->mThreads; ++aThread)
+    {
+        aFound = TopK_collect(ioTopKPtr, &ioTopKPtr->mLocals[aThread], aExact);
+        TopK_merge(aSummary, &aUsed, ioTopKPtr->mCapacity, aExact, aFound);
+    }
+    pthread_mutex_unlock(&ioTopKPtr->mGlobalLock);
+
+    qsort(aSummary, aUsed, sizeof(tTopK_entry), TopK_byCount);
+    aUsed = (aUsed < iK) ? aUsed : iK;
+    memcpy(oEntries, aSummary, aUsed * sizeof(tTopK_entry));
+
+    free(aExact);
+    free(aSummary);
+    return aUsed;
+}
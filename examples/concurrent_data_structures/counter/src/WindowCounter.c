@@ -0,0 +1,173 @@
+#include <WindowCounter.h>
+#include <assert.h>
+#include <counter_platform.h>
+#include <memory.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define kWindowCounter_busy UINT64_MAX // bucket tag while its owner recycles it
+
+/**
+ * @brief One time bucket of a ring. Only the ring's owner writes it.
+ */
+typedef struct
+{
+    _Atomic uint64_t mEpoch; // bucket number held (monotonic ms / mBucketMs)
+    _Atomic uint64_t mCount; // events in that bucket
+} tWindowCounter_bucket;
+
+struct __tWindowCounter
+{
+    uint32_t mThreads;                  // number of rings
+    uint32_t mBucketMs;                 // bucket width
+    uint32_t mBuckets;                  // buckets per ring
+    size_t mRingStride;                 // buckets between rings (whole cache lines)
+    clockid_t mClock;                   // monotonic clock to read
+    tWindowCounter_bucket *mBucketsPtr; // per-thread rings
+};
+
+/**
+ * @brief Current bucket number.
+ */
+static inline uint64_t WindowCounter_epoch(const tWindowCounter *iCounterPtr)
+{
+    struct timespec aTimeSpec;
+    clock_gettime(iCounterPtr->mClock, &aTimeSpec);
+    return ((uint64_t)aTimeSpec.tv_sec * 1000u + (uint64_t)aTimeSpec.tv_nsec / 1000000u) / iCounterPtr->mBucketMs;
+}
+
+tWindowCounter *WindowCounter_create(const tWindowCounter_options *iOptionsPtr)
+{
+    size_t aRingBytes;
+    tWindowCounter *aCounterPtr;
+
+    assert(iOptionsPtr != NULL);    // required parameter
+    assert(iOptionsPtr->mThreads);  // need at least one ring
+    assert(iOptionsPtr->mBucketMs); // buckets need a width
+    assert(iOptionsPtr->mBuckets);  // need at least one bucket
+
+    aCounterPtr = malloc(sizeof(tWindowCounter));
+    assert(aCounterPtr != NULL);
+    memset(aCounterPtr, 0, sizeof(tWindowCounter)); // blank slate
+
+    aCounterPtr->mThreads = iOptionsPtr->mThreads;
+    aCounterPtr->mBucketMs = iOptionsPtr->mBucketMs;
+    aCounterPtr->mBuckets = iOptionsPtr->mBuckets;
+#ifdef CLOCK_MONOTONIC_COARSE
+    // the coarse clock ticks every few ms; fine for buckets much wider than that
+    aCounterPtr->mClock = (aCounterPtr->mBucketMs >= 10) ? CLOCK_MONOTONIC_COARSE : CLOCK_MONOTONIC;
+#else
+    aCounterPtr->mClock = CLOCK_MONOTONIC;
+#endif
+
+    aRingBytes = Counter_cacheLineRound(aCounterPtr->mBuckets * sizeof(tWindowCounter_bucket));
+    aCounterPtr->mRingStride = aRingBytes / sizeof(tWindowCounter_bucket);
+    aCounterPtr->mBucketsPtr = aligned_alloc(kCounter_cacheLineSize, aCounterPtr->mThreads * aRingBytes);
+    assert(aCounterPtr->mBucketsPtr != NULL);
+
+    WindowCounter_reset(aCounterPtr);
+
+    return aCounterPtr;
+}
+
+void WindowCounter_destroy(tWindowCounter *ioCounterPtr)
+{
+    if (ioCounterPtr == NULL)
+    {
+        return;
+    }
+
+    free(ioCounterPtr->mBucketsPtr);
+    free(ioCounterPtr);
+}
+
+void WindowCounter_reset(tWindowCounter *ioCounterPtr)
+{
+    size_t aBucket;
+
+    if (ioCounterPtr == NULL)
+    {
+        return;
+    }
+
+    for (aBucket = 0; aBucket < ioCounterPtr->mThreads * ioCounterPtr->mRingStride; ++aBucket)
+    {
+        atomic_store_explicit(&ioCounterPtr->mBucketsPtr[aBucket].mEpoch, 0, memory_order_relaxed);
+        atomic_store_explicit(&ioCounterPtr->mBucketsPtr[aBucket].mCount, 0, memory_order_relaxed);
+    }
+}
+
+void WindowCounter_flush(tWindowCounter *ioCounterPtr, const uint32_t iThread)
+{
+    (void)ioCounterPtr;
+    (void)iThread;
+}
+
+void WindowCounter_add(tWindowCounter *ioCounterPtr, const uint32_t iThread, const uint32_t iAmount)
+{
+    uint64_t aEpoch;
+    tWindowCounter_bucket *aBucketPtr;
+
+    assert(iThread < ioCounterPtr->mThreads);
+
+    aEpoch = WindowCounter_epoch(ioCounterPtr);
+    aBucketPtr = &ioCounterPtr->mBucketsPtr[iThread * ioCounterPtr->mRingStride + aEpoch % ioCounterPtr->mBuckets];
+
+    if (atomic_load_explicit(&aBucketPtr->mEpoch, memory_order_relaxed) != aEpoch)
+    {
+        // recycle a bucket that last held an older time, seqlock style: the
+        // tag is invalidated before the count changes and published after,
+        // so a reader seeing the same tag on both sides of its count load
+        // read the count that belongs to that tag
+        atomic_store_explicit(&aBucketPtr->mEpoch, kWindowCounter_busy, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        atomic_store_explicit(&aBucketPtr->mCount, iAmount, memory_order_relaxed);
+        atomic_store_explicit(&aBucketPtr->mEpoch, aEpoch, memory_order_release);
+        return;
+    }
+    atomic_store_explicit(&aBucketPtr->mCount,
+                          atomic_load_explicit(&aBucketPtr->mCount, memory_order_relaxed) + iAmount,
+                          memory_order_relaxed);
+}
+
+uint64_t WindowCounter_count(tWindowCounter *ioCounterPtr, const uint32_t iWindowMs)
+{
+    uint32_t aThread;
+    uint32_t aBucket;
+    uint32_t aSpan;
+    uint64_t aNow;
+    uint64_t aEpoch;
+    uint64_t aCount;
+    uint64_t aTotal;
+    tWindowCounter_bucket *aBucketPtr;
+
+    // buckets overlapping the window, the current one included
+    aSpan = (iWindowMs + ioCounterPtr->mBucketMs - 1) / ioCounterPtr->mBucketMs;
+    aSpan = (aSpan == 0) ? 1 : aSpan;
+    aSpan = (aSpan > ioCounterPtr->mBuckets) ? ioCounterPtr->mBuckets : aSpan;
+
+    aNow = WindowCounter_epoch(ioCounterPtr);
+    aTotal = 0;
+    for (aThread = 0; aThread < ioCounterPtr->mThreads; ++aThread)
+    {
+        for (aBucket = 0; aBucket < ioCounterPtr->mBuckets; ++aBucket)
+        {
+            aBucketPtr = &ioCounterPtr->mBucketsPtr[aThread * ioCounterPtr->mRingStride + aBucket];
+            aEpoch = atomic_load_explicit(&aBucketPtr->mEpoch, memory_order_acquire);
+            if (aEpoch + aSpan <= aNow || aEpoch > aNow)
+            {
+                continue; // outside the window, being recycled, or from a writer ahead of our clock read
+            }
+            aCount = atomic_load_explicit(&aBucketPtr->mCount, memory_order_relaxed);
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&aBucketPtr->mEpoch, memory_order_relaxed) == aEpoch)
+            {
+                aTotal += aCount;
+            }
+        }
+    }
+    return aTotal;
+}
@@ -1,36 +1,347 @@
 #include <assert.h>
 #include <getopt.h>
+#include <malloc.h>
 #include <pthread.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 #include <time.h>
 #include <unistd.h>
 
 #include <ApproximateCounter.h>
+#include <AtomicCounter.h>
+#include <CompactCounter.h>
+#include <CountMinSketch.h>
+#include <CounterMap.h>
+#include <DelegationCounter.h>
+#include <DynamicCounter.h>
+#include <FlatCombiningCounter.h>
+#include <HierarchicalCounter.h>
+#include <Histogram.h>
+#include <PerCpuCounter.h>
+#include <ProbabilisticCounter.h>
+#include <SharedCounter.h>
+#include <SummingCounter.h>
 #include <TraditionalCounter.h>
 
 enum
 {
     kBenchCounter_idxApprox = 0,
+    kBenchCounter_idxApproxPadded,
+    kBenchCounter_idxApproxOwner,
+    kBenchCounter_idxApproxBackground,
+    kBenchCounter_idxApproxAdaptive,
     kBenchCounter_idxTrad,
+    kBenchCounter_idxAtomic,
+    kBenchCounter_idxAtomicBackoff,
+    kBenchCounter_idxSumming,
+    kBenchCounter_idxPerCpu,
+    kBenchCounter_idxHierarchical,
+    kBenchCounter_idxFlatCombining,
+    kBenchCounter_idxDelegation,
+    kBenchCounter_idxDynamic,
+    kBenchCounter_idxCompact8,
+    kBenchCounter_idxCompact16,
+    kBenchCounter_idxProbabilistic,
     kBenchCounter_idxCount
 };
 
+#define kBenchCounter_allDUTs ((1u << kBenchCounter_idxCount) - 1u)
+#define kBenchCounter_relativeError 0.02 // Relative error of estimating counters outside sweep_error
+#define kBenchCounter_footprintSamples 64 // Instances created to measure the heap footprint of one counter
+#define kBenchCounter_compactCounters 1024 // Capacity of the CompactCounter slabs (footprint samples plus the DUT)
+#define kBenchCounter_counterCsvHeader \
+    "counter,n_threads,threshold,time (ms),final_count,read_interval,relative_error,bytes_per_counter (glibc mallinfo2)\n"
+
+/**
+ * @brief Storage for the options of any counter under test.
+ */
+typedef union
+{
+    tApproximateCounter_options mApprox;
+    tAtomicCounter_options mAtomic;
+    tSummingCounter_options mSumming;
+    tHierarchicalCounter_options mHierarchical;
+    tFlatCombiningCounter_options mFlatCombining;
+    tDelegationCounter_options mDelegation;
+    tDynamicCounter_options mDynamic;
+    tCompactCounter_options mCompact;
+    tProbabilisticCounter_options mProbabilistic;
+} tBenchCounter_options;
+
+/**
+ * @brief Fill in the create options of a counter under test.
+ *
+ * @param iNumThreads Number of threads that will drive the counter.
+ * @param iThreshold Threshold parameter of the sweep.
+ * @param iRelativeError Target relative error of the estimating counters.
+ * @param oOptionsPtr Storage to build the options in.
+ * @return Options pointer to hand to mCreatePtr (may be NULL).
+ */
+typedef const void *(tBenchCounter_makeOptions)(uint32_t iNumThreads,
+                                                 uint32_t iThreshold,
+                                                 double iRelativeError,
+                                                 tBenchCounter_options *oOptionsPtr);
+
 typedef struct
 {
+    const char *mNamePtr;
     const tCounter_interface *mInterfacePtr;
+    tBenchCounter_makeOptions *mMakeOptionsPtr;
     uint32_t mComponentId;
 } tBenchCounter_DUT;
 
+static const void *BenchCounter_approxOptions(uint32_t iNumThreads,
+                                              uint32_t iThreshold,
+                                              double iRelativeError,
+                                              tBenchCounter_options *oOptionsPtr)
+{
+    oOptionsPtr->mApprox.mThreshold = iThreshold;
+    oOptionsPtr->mApprox.mThreads = iNumThreads;
+    oOptionsPtr->mApprox.mLayout = kApproximateCounter_layoutDense;
+    oOptionsPtr->mApprox.mSync = kApproximateCounter_syncLocked;
+    oOptionsPtr->mApprox.mFlushPeriodMs = 0;
+    oOptionsPtr->mApprox.mMaxThreshold = 0;
+    return &oOptionsPtr->mApprox;
+}
+
+static const void *BenchCounter_approxPaddedOptions(uint32_t iNumThreads,
+                                                    uint32_t iThreshold,
+                                                    double iRelativeError,
+                                                    tBenchCounter_options *oOptionsPtr)
+{
+    BenchCounter_approxOptions(iNumThreads, iThreshold, iRelativeError, oOptionsPtr);
+    oOptionsPtr->mApprox.mLayout = kApproximateCounter_layoutPadded;
+    return &oOptionsPtr->mApprox;
+}
+
+static const void *BenchCounter_approxOwnerOptions(uint32_t iNumThreads,
+                                                   uint32_t iThreshold,
+                                                   double iRelativeError,
+                                                   tBenchCounter_options *oOptionsPtr)
+{
+    BenchCounter_approxPaddedOptions(iNumThreads, iThreshold, iRelativeError, oOptionsPtr);
+    oOptionsPtr->mApprox.mSync = kApproximateCounter_syncOwner;
+    return &oOptionsPtr->mApprox;
+}
+
+static const void *BenchCounter_approxBackgroundOptions(uint32_t iNumThreads,
+                                                        uint32_t iThreshold,
+                                                        double iRelativeError,
+                                                        tBenchCounter_options *oOptionsPtr)
+{
+    BenchCounter_approxOwnerOptions(iNumThreads, iThreshold, iRelativeError, oOptionsPtr);
+    oOptionsPtr->mApprox.mFlushPeriodMs = 1;
+    return &oOptionsPtr->mApprox;
+}
+
+static const void *BenchCounter_approxAdaptiveOptions(uint32_t iNumThreads,
+                                                      uint32_t iThreshold,
+                                                      double iRelativeError,
+                                                      tBenchCounter_options *oOptionsPtr)
+{
+    // adapt within [threshold / 64, threshold], i.e. the accuracy of the sweep
+    BenchCounter_approxPaddedOptions(iNumThreads, iThreshold, iRelativeError, oOptionsPtr);
+    oOptionsPtr->mApprox.mThreshold = (iThreshold >= 64) ? iThreshold / 64 : 1;
+    oOptionsPtr->mApprox.mMaxThreshold = iThreshold;
+    return &oOptionsPtr->mApprox;
+}
+
+static const void *BenchCounter_noOptions(uint32_t iNumThreads,
+                                          uint32_t iThreshold,
+                                          double iRelativeError,
+                                          tBenchCounter_options *oOptionsPtr)
+{
+    return NULL;
+}
+
+static const void *BenchCounter_atomicBackoffOptions(uint32_t iNumThreads,
+                                                     uint32_t iThreshold,
+                                                     double iRelativeError,
+                                                     tBenchCounter_options *oOptionsPtr)
+{
+    oOptionsPtr->mAtomic.mBackoff = kAtomicCounter_backoffSpin;
+    oOptionsPtr->mAtomic.mMaxSpins = 256;
+    return &oOptionsPtr->mAtomic;
+}
+
+static const void *BenchCounter_summingOptions(uint32_t iNumThreads,
+                                               uint32_t iThreshold,
+                                               double iRelativeError,
+                                               tBenchCounter_options *oOptionsPtr)
+{
+    oOptionsPtr->mSumming.mThreads = iNumThreads;
+    return &oOptionsPtr->mSumming;
+}
+
+static const void *BenchCounter_hierarchicalOptions(uint32_t iNumThreads,
+                                                    uint32_t iThreshold,
+                                                    double iRelativeError,
+                                                    tBenchCounter_options *oOptionsPtr)
+{
+    oOptionsPtr->mHierarchical.mThreshold = iThreshold;
+    oOptionsPtr->mHierarchical.mNodeThreshold = 8 * iThreshold;
+    oOptionsPtr->mHierarchical.mThreads = iNumThreads;
+    oOptionsPtr->mHierarchical.mGroup = kHierarchicalCounter_groupLlc;
+    return &oOptionsPtr->mHierarchical;
+}
+
+static const void *BenchCounter_flatCombiningOptions(uint32_t iNumThreads,
+                                                     uint32_t iThreshold,
+                                                     double iRelativeError,
+                                                     tBenchCounter_options *oOptionsPtr)
+{
+    oOptionsPtr->mFlatCombining.mThreads = iNumThreads;
+    return &oOptionsPtr->mFlatCombining;
+}
+
+static const void *BenchCounter_delegationOptions(uint32_t iNumThreads,
+                                                  uint32_t iThreshold,
+                                                  double iRelativeError,
+                                                  tBenchCounter_options *oOptionsPtr)
+{
+    oOptionsPtr->mDelegation.mThreads = iNumThreads;
+    return &oOptionsPtr->mDelegation;
+}
+
+static const void *BenchCounter_dynamicOptions(uint32_t iNumThreads,
+                                               uint32_t iThreshold,
+                                               double iRelativeError,
+                                               tBenchCounter_options *oOptionsPtr)
+{
+    oOptionsPtr->mDynamic.mThreshold = iThreshold;
+    return &oOptionsPtr->mDynamic;
+}
+
+/**
+ * @brief Slab of CompactCounter slots for iNumThreads threads, one per width.
+ *
+ * A slab is kept until the thread count changes, as a service holding many
+ * counters would keep it; the counters created on it come and go.
+ */
+static tCompactCounter_slab *BenchCounter_compactSlab(uint32_t iNumThreads, tCompactCounter_width iWidth)
+{
+    static tCompactCounter_slab *sSlabPtr[2];
+    static uint32_t sThreads[2];
+    uint32_t aSlab;
+    tCompactCounter_slabOptions aOptions;
+
+    aSlab = (iWidth == kCompactCounter_width8) ? 0 : 1;
+    if (sSlabPtr[aSlab] == NULL || sThreads[aSlab] != iNumThreads)
+    {
+        CompactCounter_destroySlab(sSlabPtr[aSlab]);
+        aOptions.mThreads = iNumThreads;
+        aOptions.mCounters = kBenchCounter_compactCounters;
+        aOptions.mWidth = iWidth;
+        sSlabPtr[aSlab] = CompactCounter_createSlab(&aOptions);
+        sThreads[aSlab] = iNumThreads;
+    }
+    return sSlabPtr[aSlab];
+}
+
+static const void *BenchCounter_compact8Options(uint32_t iNumThreads,
+                                                uint32_t iThreshold,
+                                                double iRelativeError,
+                                                tBenchCounter_options *oOptionsPtr)
+{
+    oOptionsPtr->mCompact.mThreshold = iThreshold;
+    oOptionsPtr->mCompact.mSlabPtr = BenchCounter_compactSlab(iNumThreads, kCompactCounter_width8);
+    return &oOptionsPtr->mCompact;
+}
+
+static const void *BenchCounter_compact16Options(uint32_t iNumThreads,
+                                                 uint32_t iThreshold,
+                                                 double iRelativeError,
+                                                 tBenchCounter_options *oOptionsPtr)
+{
+    oOptionsPtr->mCompact.mThreshold = iThreshold;
+    oOptionsPtr->mCompact.mSlabPtr = BenchCounter_compactSlab(iNumThreads, kCompactCounter_width16);
+    return &oOptionsPtr->mCompact;
+}
+
+static const void *BenchCounter_probabilisticOptions(uint32_t iNumThreads,
+                                                     uint32_t iThreshold,
+                                                     double iRelativeError,
+                                                     tBenchCounter_options *oOptionsPtr)
+{
+    oOptionsPtr->mProbabilistic.mBase = 0.0;
+    oOptionsPtr->mProbabilistic.mRelativeError = iRelativeError;
+    return &oOptionsPtr->mProbabilistic;
+}
+
 static const tBenchCounter_DUT sBenchCounter_DUTs[] =
     {
-        {&gApproximateCounter_interface,
+        {"approximate",
+         &gApproximateCounter_interface,
+         BenchCounter_approxOptions,
          kBenchCounter_idxApprox},
-        {&gTraditionalCounter_interface,
-         kBenchCounter_idxTrad}};
+        {"approximate_padded",
+         &gApproximateCounter_interface,
+         BenchCounter_approxPaddedOptions,
+         kBenchCounter_idxApproxPadded},
+        {"approximate_owner",
+         &gApproximateCounter_interface,
+         BenchCounter_approxOwnerOptions,
+         kBenchCounter_idxApproxOwner},
+        {"approximate_background",
+         &gApproximateCounter_interface,
+         BenchCounter_approxBackgroundOptions,
+         kBenchCounter_idxApproxBackground},
+        {"approximate_adaptive",
+         &gApproximateCounter_interface,
+         BenchCounter_approxAdaptiveOptions,
+         kBenchCounter_idxApproxAdaptive},
+        {"traditional",
+         &gTraditionalCounter_interface,
+         BenchCounter_noOptions,
+         kBenchCounter_idxTrad},
+        {"atomic",
+         &gAtomicCounter_interface,
+         BenchCounter_noOptions,
+         kBenchCounter_idxAtomic},
+        {"atomic_backoff",
+         &gAtomicCounter_interface,
+         BenchCounter_atomicBackoffOptions,
+         kBenchCounter_idxAtomicBackoff},
+        {"summing",
+         &gSummingCounter_interface,
+         BenchCounter_summingOptions,
+         kBenchCounter_idxSumming},
+        {"per_cpu",
+         &gPerCpuCounter_interface,
+         BenchCounter_noOptions,
+         kBenchCounter_idxPerCpu},
+        {"hierarchical",
+         &gHierarchicalCounter_interface,
+         BenchCounter_hierarchicalOptions,
+         kBenchCounter_idxHierarchical},
+        {"flat_combining",
+         &gFlatCombiningCounter_interface,
+         BenchCounter_flatCombiningOptions,
+         kBenchCounter_idxFlatCombining},
+        {"delegation",
+         &gDelegationCounter_interface,
+         BenchCounter_delegationOptions,
+         kBenchCounter_idxDelegation},
+        {"dynamic",
+         &gDynamicCounter_interface,
+         BenchCounter_dynamicOptions,
+         kBenchCounter_idxDynamic},
+        {"compact8",
+         &gCompactCounter_interface,
+         BenchCounter_compact8Options,
+         kBenchCounter_idxCompact8},
+        {"compact16",
+         &gCompactCounter_interface,
+         BenchCounter_compact16Options,
+         kBenchCounter_idxCompact16},
+        {"probabilistic",
+         &gProbabilisticCounter_interface,
+         BenchCounter_probabilisticOptions,
+         kBenchCounter_idxProbabilistic}};
 
 /**
  * @brief Thread worker context.
@@ -39,12 +350,46 @@ typedef struct __tBenchCounter_context
 {
     uint32_t mThread;                        // Thread ID (unique among the workers in a workload)
     uint32_t mNumIncrements;                 // Number of times to increment the counter
+    uint32_t mReadInterval;                  // Increments between two reads of the counter (0: never read)
     tCounter_instance *mCounterPtr;          // Shared counter for all threads to increment
     const tCounter_interface *mInterfacePtr; // Interface to use with the counter instance
+    tHistogram *mLatencyPtr;                 // Per-increment latency in ns (NULL: not recorded)
 } tBenchCounter_context;
 
 /**
- * @brief Arguments for sweep_threads subcommand.
+ * @brief Sketch worker context.
+ */
+typedef struct
+{
+    uint32_t mThread;            // Thread ID (unique among the workers in a workload)
+    uint32_t mNumUpdates;        // Number of keys to count
+    uint32_t mNumKeys;           // Keys are drawn uniformly from [0, mNumKeys)
+    tCountMinSketch *mSketchPtr; // Shared sketch for all threads to update
+} tBenchCounter_sketchContext;
+
+/**
+ * @brief Shared-memory counter worker context.
+ */
+typedef struct
+{
+    uint32_t mWorker;            // Worker ID (unique among the threads or processes in a workload)
+    uint32_t mNumIncrements;     // Number of times to increment the counter
+    tSharedCounter *mCounterPtr; // Counter segment shared by all workers
+} tBenchCounter_sharedContext;
+
+/**
+ * @brief Counter map worker context.
+ */
+typedef struct
+{
+    uint32_t mThread;     // Thread ID (unique among the workers in a workload)
+    uint32_t mNumUpdates; // Number of keys to count
+    uint32_t mNumKeys;    // Keys are drawn uniformly from [0, mNumKeys)
+    tCounterMap *mMapPtr; // Shared map for all threads to update
+} tBenchCounter_mapContext;
+
+/**
+ * @brief Arguments for sweep_threads and sweep_latency subcommands.
  */
 typedef struct
 {
@@ -70,21 +415,109 @@ typedef struct
     uint32_t mHotruns;        // Number of hot runs
 } tBenchCounter_sweepThresholdArgs;
 
+/**
+ * @brief Arguments for sweep_reads subcommand.
+ */
+typedef struct
+{
+    uint32_t mNumThreads;    // Number of threads (constant)
+    uint32_t mThreshold;     // Threshold for approximate counter
+    uint32_t mStartInterval; // Starting read interval (increments per read)
+    uint32_t mSteps;         // Number of read interval steps (multiply by 2 each step)
+    uint32_t mIncrements;    // Number of increments per thread
+    uint32_t mWarmups;       // Number of warmup runs
+    uint32_t mHotruns;       // Number of hot runs
+} tBenchCounter_sweepReadsArgs;
+
+/**
+ * @brief Arguments for sweep_error subcommand.
+ */
+typedef struct
+{
+    uint32_t mNumThreads; // Number of threads (constant)
+    double mStartError;   // Starting relative error (divide by 2 each step)
+    uint32_t mSteps;      // Number of relative error steps
+    uint32_t mIncrements; // Number of increments per thread
+    uint32_t mWarmups;    // Number of warmup runs
+    uint32_t mHotruns;    // Number of hot runs
+} tBenchCounter_sweepErrorArgs;
+
+/**
+ * @brief Returns the current monotonic time in nanoseconds.
+ */
+static inline uint64_t BenchCounter_nowNs(void)
+{
+    struct timespec aTimeSpec;
+    clock_gettime(CLOCK_MONOTONIC, &aTimeSpec);
+    return (uint64_t)aTimeSpec.tv_sec * 1000000000u + (uint64_t)aTimeSpec.tv_nsec;
+}
+
+/**
+ * @brief Arguments for sweep_sketch subcommand.
+ */
+typedef struct
+{
+    uint32_t mMinThreads; // Minimum number of threads
+    uint32_t mMaxThreads; // Maximum number of threads
+    uint32_t mStep;       // Step size for thread increments
+    uint32_t mDepth;      // Count-min sketch rows
+    uint32_t mWidth;      // Count-min sketch counters per row
+    uint32_t mKeys;       // Size of the key space
+    uint32_t mIncrements; // Number of updates per thread
+    uint32_t mWarmups;    // Number of warmup runs
+    uint32_t mHotruns;    // Number of hot runs
+} tBenchCounter_sweepSketchArgs;
+
+/**
+ * @brief Arguments for sweep_processes subcommand.
+ */
+typedef struct
+{
+    uint32_t mMinWorkers; // Minimum number of workers
+    uint32_t mMaxWorkers; // Maximum number of workers
+    uint32_t mStep;       // Step size for worker increments
+    uint32_t mIncrements; // Number of increments per worker
+    uint32_t mWarmups;    // Number of warmup runs
+    uint32_t mHotruns;    // Number of hot runs
+} tBenchCounter_sweepProcessesArgs;
+
+/**
+ * @brief Arguments for sweep_keys subcommand.
+ */
+typedef struct
+{
+    uint32_t mNumThreads; // Number of threads (constant)
+    uint32_t mThreshold;  // Per-thread delta at which a key is flushed
+    uint32_t mStartKeys;  // Starting number of keys (multiply by 2 each step)
+    uint32_t mSteps;      // Number of key count steps
+    uint32_t mIncrements; // Number of updates per thread
+    uint32_t mWarmups;    // Number of warmup runs
+    uint32_t mHotruns;    // Number of hot runs
+} tBenchCounter_sweepKeysArgs;
+
 /**
  * @brief Thread worker method.
  *
  * Does a single thread's work on a counter. This amounts to incrementing
- * the input counter one-million times.
+ * the input counter one-million times, reading it back every mReadInterval
+ * increments when a read interval is set. When a latency histogram is set,
+ * every increment is timed and recorded instead (reads are skipped).
  *
  * @param ioWorkerContext Input context for the thread worker.
  */
 void *BenchCounter_worker(void *ioWorkerContext)
 {
+    uint32_t aCount;
     uint32_t aIncrement;
     uint32_t aNumIncrements;
+    uint32_t aReadInterval;
+    uint32_t aSinceRead;
     uint32_t aThread;
+    uint64_t aT0;
+    uint64_t aT1;
     tCounter_instance *aCounterPtr;
     const tCounter_interface *aInterfacePtr;
+    tHistogram *aLatencyPtr;
     tBenchCounter_context *aWorkerContext;
 
     aWorkerContext = (tBenchCounter_context *)ioWorkerContext;
@@ -93,10 +526,38 @@ void *BenchCounter_worker(void *ioWorkerContext)
     aCounterPtr = aWorkerContext->mCounterPtr;
     aInterfacePtr = aWorkerContext->mInterfacePtr;
     aNumIncrements = aWorkerContext->mNumIncrements;
+    aReadInterval = aWorkerContext->mReadInterval;
+    aLatencyPtr = aWorkerContext->mLatencyPtr;
 
-    for (aIncrement = 0; aIncrement < aNumIncrements; ++aIncrement)
+    if (aLatencyPtr != NULL)
+    {
+        for (aIncrement = 0; aIncrement < aNumIncrements; ++aIncrement)
+        {
+            aT0 = BenchCounter_nowNs();
+            aInterfacePtr->mIncrementPtr(aCounterPtr, aThread, 1);
+            aT1 = BenchCounter_nowNs();
+            Histogram_record(aLatencyPtr, aThread, aT1 - aT0);
+        }
+    }
+    else if (aReadInterval == 0)
+    {
+        for (aIncrement = 0; aIncrement < aNumIncrements; ++aIncrement)
+        {
+            aInterfacePtr->mIncrementPtr(aCounterPtr, aThread, 1);
+        }
+    }
+    else
     {
-        aInterfacePtr->mIncrementPtr(aCounterPtr, aThread, 1);
+        aSinceRead = 0;
+        for (aIncrement = 0; aIncrement < aNumIncrements; ++aIncrement)
+        {
+            aInterfacePtr->mIncrementPtr(aCounterPtr, aThread, 1);
+            if (++aSinceRead == aReadInterval)
+            {
+                aSinceRead = 0;
+                aInterfacePtr->mGetPtr(aCounterPtr, &aCount);
+            }
+        }
     }
 
     aInterfacePtr->mFlushPtr(aCounterPtr, aThread); // flush the remaining local count
@@ -104,6 +565,93 @@ void *BenchCounter_worker(void *ioWorkerContext)
     return NULL;
 }
 
+/**
+ * @brief Sketch thread worker method.
+ *
+ * Counts mNumUpdates keys drawn from a per-thread xorshift64 generator.
+ *
+ * @param ioWorkerContext Input tBenchCounter_sketchContext for the thread worker.
+ */
+void *BenchCounter_sketchWorker(void *ioWorkerContext)
+{
+    uint32_t aUpdate;
+    uint64_t aState;
+    tBenchCounter_sketchContext *aWorkerContext;
+
+    aWorkerContext = (tBenchCounter_sketchContext *)ioWorkerContext;
+    aState = 0x9e3779b97f4a7c15ull * (aWorkerContext->mThread + 1);
+
+    for (aUpdate = 0; aUpdate < aWorkerContext->mNumUpdates; ++aUpdate)
+    {
+        aState ^= aState << 13;
+        aState ^= aState >> 7;
+        aState ^= aState << 17;
+        CountMinSketch_add(aWorkerContext->mSketchPtr, aWorkerContext->mThread,
+                           aState % aWorkerContext->mNumKeys, 1);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Next key of a worker's key stream (xorshift64, as in the sketch
+ *        worker). The stream only depends on the thread ID, so the expected
+ *        counts can be replayed after a run.
+ */
+static inline uint64_t BenchCounter_nextKey(uint64_t *ioStatePtr, uint32_t iNumKeys)
+{
+    *ioStatePtr ^= *ioStatePtr << 13;
+    *ioStatePtr ^= *ioStatePtr >> 7;
+    *ioStatePtr ^= *ioStatePtr << 17;
+    return *ioStatePtr % iNumKeys;
+}
+
+/**
+ * @brief Counter map thread worker method.
+ *
+ * Adds 1 to mNumUpdates keys of its key stream, then flushes its cached
+ * deltas.
+ *
+ * @param ioWorkerContext Input tBenchCounter_mapContext for the thread worker.
+ */
+void *BenchCounter_mapWorker(void *ioWorkerContext)
+{
+    uint32_t aUpdate;
+    uint64_t aKey;
+    uint64_t aState;
+    tBenchCounter_mapContext *aWorkerContext;
+
+    aWorkerContext = (tBenchCounter_mapContext *)ioWorkerContext;
+    aState = 0x9e3779b97f4a7c15ull * (aWorkerContext->mThread + 1);
+
+    for (aUpdate = 0; aUpdate < aWorkerContext->mNumUpdates; ++aUpdate)
+    {
+        aKey = BenchCounter_nextKey(&aState, aWorkerContext->mNumKeys);
+        CounterMap_add(aWorkerContext->mMapPtr, aWorkerContext->mThread, &aKey, sizeof(aKey), 1);
+    }
+    CounterMap_flush(aWorkerContext->mMapPtr, aWorkerContext->mThread);
+    return NULL;
+}
+
+/**
+ * @brief Shared-memory counter worker method, run by a thread or a child
+ *        process.
+ *
+ * @param ioWorkerContext Input tBenchCounter_sharedContext for the worker.
+ */
+void *BenchCounter_sharedWorker(void *ioWorkerContext)
+{
+    uint32_t aIncrement;
+    tBenchCounter_sharedContext *aWorkerContext;
+
+    aWorkerContext = (tBenchCounter_sharedContext *)ioWorkerContext;
+
+    for (aIncrement = 0; aIncrement < aWorkerContext->mNumIncrements; ++aIncrement)
+    {
+        SharedCounter_add(aWorkerContext->mCounterPtr, aWorkerContext->mWorker, 0, 1);
+    }
+    return NULL;
+}
+
 /**
  * @brief Returns the current monotonic time in milliseconds.
  *
@@ -160,6 +708,60 @@ uint32_t BenchCounter_runWorkload(pthread_t *iCounterDriverThreadPtr,
     return -1;
 }
 
+/**
+ * @brief Heap footprint of one counter instance.
+ *
+ * Creates kBenchCounter_footprintSamples instances side by side and divides
+ * the growth of glibc's mallinfo2 in-use bytes, so chunks recycled from the
+ * thread cache only skew the result by a few percent. State that worker
+ * threads allocate lazily (such as DynamicCounter slots) is not included;
+ * the compact counters' share of their preallocated slab is. The size does
+ * not depend on the sweep parameters, so it is measured once per counter and
+ * thread count (creating instances can be costly: some start threads).
+ *
+ * @param iDut Index (kBenchCounter_idx*) of the counter to measure.
+ * @param iNumThreads Number of threads the instances are created for.
+ * @param iOptionsPtr Options to create the instances with.
+ * @return Bytes per counter instance, allocator overhead included.
+ */
+static size_t BenchCounter_footprint(uint32_t iDut, uint8_t iNumThreads, const void *iOptionsPtr)
+{
+    static size_t sFootprint[kBenchCounter_idxCount][UINT8_MAX + 1]; // 0: not measured yet
+    uint32_t aSample;
+    size_t aBytes;
+    const tCounter_interface *aInterfacePtr;
+    tCounter_instance aBase;
+    tCounter_instance *aCounterPtr[kBenchCounter_footprintSamples];
+
+    if (sFootprint[iDut][iNumThreads] != 0)
+    {
+        return sFootprint[iDut][iNumThreads];
+    }
+
+    aInterfacePtr = sBenchCounter_DUTs[iDut].mInterfacePtr;
+    aBase.mCounterId = 0;
+    aBytes = mallinfo2().uordblks;
+    for (aSample = 0; aSample < kBenchCounter_footprintSamples; ++aSample)
+    {
+        aCounterPtr[aSample] = aInterfacePtr->mCreatePtr(&aBase, iOptionsPtr);
+        assert(aCounterPtr[aSample] != NULL);
+    }
+    aBytes = mallinfo2().uordblks - aBytes;
+    for (aSample = 0; aSample < kBenchCounter_footprintSamples; ++aSample)
+    {
+        aInterfacePtr->mDestroyPtr(aCounterPtr[aSample]);
+    }
+    aBytes /= kBenchCounter_footprintSamples;
+
+    if (iDut == kBenchCounter_idxCompact8 || iDut == kBenchCounter_idxCompact16)
+    {
+        aBytes += CompactCounter_slotBytes(((const tCompactCounter_options *)iOptionsPtr)->mSlabPtr);
+    }
+
+    sFootprint[iDut][iNumThreads] = aBytes;
+    return aBytes;
+}
+
 /**
  * @brief Benchmark a counter.
  *
@@ -169,20 +771,28 @@ uint32_t BenchCounter_runWorkload(pthread_t *iCounterDriverThreadPtr,
  * a number of times before beginning measurements to bring the CPU frequency up
  * to a stable value, warm the working memory and caches, and clear out any first-
  * run tasks like dynamic loading, allocator initializion, thread stack/memory
- * set-up, etc.
+ * set-up, etc. It also records the heap footprint of one counter instance
+ * (see BenchCounter_footprint).
  *
+ * @param iDutMask Bit mask (by kBenchCounter_idx*) of the counters to run.
  * @param iNumThreads Number of threads to run with.
  * @param iThreshold Approximate counter threshold (see approximate_counter.h).
+ * @param iRelativeError Target relative error of the estimating counters.
  * @param iNumIncrements How many times to increment each local thread's counter.
+ * @param iReadInterval Increments between two reads of the counter by each
+ *                      thread (0: never read during the workload).
  * @param iNumWarmups How many times to run the workload and discard the results
  *                    before taking measurements.
  * @param iNumHotRuns How many times to run the workload while taking measurements.
  *
  * @return uint32_t Median runtime of all the measured runs.
  */
-uint32_t BenchCounter_benchApproximateCounter(uint8_t iNumThreads,
+uint32_t BenchCounter_benchApproximateCounter(uint32_t iDutMask,
+                                              uint8_t iNumThreads,
                                               uint32_t iThreshold,
+                                              double iRelativeError,
                                               uint32_t iNumIncrements,
+                                              uint32_t iReadInterval,
                                               uint32_t iNumWarmups,
                                               uint32_t iNumHotRuns,
                                               FILE *iOutputFilePtr)
@@ -192,6 +802,7 @@ uint32_t BenchCounter_benchApproximateCounter(uint8_t iNumThreads,
     uint32_t aStatusCode;
     uint32_t aThread;
     uint32_t aDut;
+    size_t aBytes;
     double aRuntime;
     double aT0;
     double aT1;
@@ -199,13 +810,16 @@ uint32_t BenchCounter_benchApproximateCounter(uint8_t iNumThreads,
     tBenchCounter_context *aContextPtr;
     tCounter_instance aBasePtr;
     tCounter_instance *aCounterPtr;
-    tApproximateCounter_options aOptions;
-
-    // Counter type descriptors
-    const char *aCounterNames[] = {"approximate", "traditional"};
+    tBenchCounter_options aOptions;
+    const void *aOptionsPtr;
 
     for (aDut = kBenchCounter_idxApprox; aDut < kBenchCounter_idxCount; ++aDut)
     {
+        if ((iDutMask & (1u << aDut)) == 0)
+        {
+            continue;
+        }
+
         // Allocate heap scratch
         aCounterDriverThreadPtr = malloc(iNumThreads * sizeof(pthread_t));
         assert(aCounterDriverThreadPtr != NULL);
@@ -214,11 +828,14 @@ uint32_t BenchCounter_benchApproximateCounter(uint8_t iNumThreads,
 
         // Create counter
         aBasePtr.mCounterId = 0;
-        aOptions.mThreshold = iThreshold;
-        aOptions.mThreads = iNumThreads;
+        aOptionsPtr = sBenchCounter_DUTs[aDut].mMakeOptionsPtr(iNumThreads,
+                                                               iThreshold,
+                                                               iRelativeError,
+                                                               &aOptions);
+        aBytes = BenchCounter_footprint(aDut, iNumThreads, aOptionsPtr);
         aCounterPtr =
             sBenchCounter_DUTs[aDut].mInterfacePtr->mCreatePtr(&aBasePtr,
-                                                               &aOptions);
+                                                               aOptionsPtr);
         assert(aCounterPtr != NULL);
 
         // Set up counter driver worker thread inputs
@@ -226,9 +843,11 @@ uint32_t BenchCounter_benchApproximateCounter(uint8_t iNumThreads,
         {
             aContextPtr[aThread].mThread = aThread;
             aContextPtr[aThread].mNumIncrements = iNumIncrements;
+            aContextPtr[aThread].mReadInterval = iReadInterval;
             aContextPtr[aThread].mCounterPtr = aCounterPtr;
             aContextPtr[aThread].mInterfacePtr =
                 sBenchCounter_DUTs[aDut].mInterfacePtr;
+            aContextPtr[aThread].mLatencyPtr = NULL;
         }
 
         // Warm-up Runs
@@ -248,7 +867,7 @@ uint32_t BenchCounter_benchApproximateCounter(uint8_t iNumThreads,
             aRuntime = aT1 - aT0;
             sBenchCounter_DUTs[aDut].mInterfacePtr->mGetPtr(aCounterPtr,
                                                             &aGlobalCount);
-            fprintf(iOutputFilePtr, "%s,%u,%u,%f,%u\n", aCounterNames[aDut], iNumThreads, iThreshold, aRuntime, aGlobalCount);
+            fprintf(iOutputFilePtr, "%s,%u,%u,%f,%u,%u,%f,%zu\n", sBenchCounter_DUTs[aDut].mNamePtr, iNumThreads, iThreshold, aRuntime, aGlobalCount, iReadInterval, iRelativeError, aBytes);
 
             sBenchCounter_DUTs[aDut].mInterfacePtr->mResetPtr(aCounterPtr);
         }
@@ -263,54 +882,511 @@ uint32_t BenchCounter_benchApproximateCounter(uint8_t iNumThreads,
 }
 
 /**
- * @brief Execute sweep_threads subcommand.
+ * @brief Measure the latency distribution of single increments.
  *
- * Sweeps across different thread counts while keeping threshold constant.
+ * Like BenchCounter_benchApproximateCounter, but every increment is timed and
+ * recorded in a per-thread Histogram. The hot runs are merged into one
+ * distribution per counter. Each sample times only the increment and one
+ * clock read; the histogram update falls outside it.
+ *
+ * @param iDutMask Bit mask (by kBenchCounter_idx*) of the counters to run.
+ * @param iNumThreads Number of threads to run with.
+ * @param iThreshold Approximate counter threshold (see approximate_counter.h).
+ * @param iNumIncrements How many times to increment each local thread's counter.
+ * @param iNumWarmups How many times to run the workload before recording.
+ * @param iNumHotRuns How many times to run the workload while recording.
  */
-int BenchCounter_sweepThreads(const tBenchCounter_sweepThreadsArgs *iArgsPtr)
+uint32_t BenchCounter_benchLatency(uint32_t iDutMask,
+                                   uint8_t iNumThreads,
+                                   uint32_t iThreshold,
+                                   uint32_t iNumIncrements,
+                                   uint32_t iNumWarmups,
+                                   uint32_t iNumHotRuns,
+                                   FILE *iOutputFilePtr)
 {
-    // Get current wall-clock time for folder and file naming
-    time_t aRawtime;
-    struct tm *aTimeinfoPtr;
-    char aTimestamp[64];
-    char aFolderName[128];
-    char aFilename[256];
-    char aFilepath[384];
-    FILE *aOutputFilePtr;
-
-    time(&aRawtime);
-    aTimeinfoPtr = localtime(&aRawtime);
-    strftime(aTimestamp, sizeof(aTimestamp), "%Y%m%d_%H%M%S", aTimeinfoPtr);
+    uint32_t aRun;
+    uint32_t aThread;
+    uint32_t aDut;
+    pthread_t *aCounterDriverThreadPtr;
+    tBenchCounter_context *aContextPtr;
+    tCounter_instance aBasePtr;
+    tCounter_instance *aCounterPtr;
+    tBenchCounter_options aOptions;
+    const void *aOptionsPtr;
+    tHistogram *aLatencyPtr;
+    tHistogram_options aLatencyOptions;
+    tHistogram_snapshot aSnapshot;
 
-    // Create benchmark folder
-    snprintf(aFolderName, sizeof(aFolderName), "benchmark_%s", aTimestamp);
-    if (mkdir(aFolderName, 0755) != 0)
+    for (aDut = kBenchCounter_idxApprox; aDut < kBenchCounter_idxCount; ++aDut)
     {
-        perror("Failed to create benchmark directory");
-        return 1;
-    }
-
-    // Create CSV filename for thread sweep
-    snprintf(aFilename, sizeof(aFilename), "sweep_threads_threshold%u_increments%u_warmups%u_hotruns%u.csv",
-             iArgsPtr->mThreshold, iArgsPtr->mIncrements, iArgsPtr->mWarmups, iArgsPtr->mHotruns);
-    snprintf(aFilepath, sizeof(aFilepath), "%s/%s", aFolderName, aFilename);
+        if ((iDutMask & (1u << aDut)) == 0)
+        {
+            continue;
+        }
 
-    // Open CSV file for writing
-    aOutputFilePtr = fopen(aFilepath, "w");
-    if (aOutputFilePtr == NULL)
-    {
-        perror("Failed to create output file");
-        return 1;
-    }
+        // Allocate heap scratch
+        aCounterDriverThreadPtr = malloc(iNumThreads * sizeof(pthread_t));
+        assert(aCounterDriverThreadPtr != NULL);
+        aContextPtr = malloc(iNumThreads * sizeof(tBenchCounter_context));
+        assert(aContextPtr != NULL);
 
-    // Write CSV header
-    fprintf(aOutputFilePtr, "counter,n_threads,threshold,time (ms),final_count\n");
+        // Create counter and latency histogram
+        aBasePtr.mCounterId = 0;
+        aOptionsPtr = sBenchCounter_DUTs[aDut].mMakeOptionsPtr(iNumThreads,
+                                                               iThreshold,
+                                                               kBenchCounter_relativeError,
+                                                               &aOptions);
+        aCounterPtr =
+            sBenchCounter_DUTs[aDut].mInterfacePtr->mCreatePtr(&aBasePtr,
+                                                               aOptionsPtr);
+        assert(aCounterPtr != NULL);
+        aLatencyOptions.mThreads = iNumThreads;
+        aLatencyOptions.mSubBucketBits = 0;
+        aLatencyPtr = Histogram_create(&aLatencyOptions);
+
+        // Set up counter driver worker thread inputs
+        for (aThread = 0; aThread < iNumThreads; ++aThread)
+        {
+            aContextPtr[aThread].mThread = aThread;
+            aContextPtr[aThread].mNumIncrements = iNumIncrements;
+            aContextPtr[aThread].mReadInterval = 0;
+            aContextPtr[aThread].mCounterPtr = aCounterPtr;
+            aContextPtr[aThread].mInterfacePtr =
+                sBenchCounter_DUTs[aDut].mInterfacePtr;
+            aContextPtr[aThread].mLatencyPtr = aLatencyPtr;
+        }
+
+        // Warm-up Runs
+        for (aRun = 0; aRun < iNumWarmups; ++aRun)
+        {
+            BenchCounter_runWorkload(aCounterDriverThreadPtr, aContextPtr, iNumThreads);
+            sBenchCounter_DUTs[aDut].mInterfacePtr->mResetPtr(aCounterPtr);
+        }
+        Histogram_reset(aLatencyPtr);
+
+        // Hot Runs
+        for (aRun = 0; aRun < iNumHotRuns; ++aRun)
+        {
+            BenchCounter_runWorkload(aCounterDriverThreadPtr, aContextPtr, iNumThreads);
+            sBenchCounter_DUTs[aDut].mInterfacePtr->mResetPtr(aCounterPtr);
+        }
+
+        Histogram_snapshot(aLatencyPtr, &aSnapshot);
+        fprintf(iOutputFilePtr, "%s,%u,%u,%llu,%llu,%llu,%llu,%llu,%llu\n", sBenchCounter_DUTs[aDut].mNamePtr, iNumThreads, iThreshold,
+                (unsigned long long)aSnapshot.mTotal,
+                (unsigned long long)Histogram_snapshotPercentile(&aSnapshot, 50.0),
+                (unsigned long long)Histogram_snapshotPercentile(&aSnapshot, 90.0),
+                (unsigned long long)Histogram_snapshotPercentile(&aSnapshot, 99.0),
+                (unsigned long long)Histogram_snapshotPercentile(&aSnapshot, 99.9),
+                (unsigned long long)Histogram_snapshotPercentile(&aSnapshot, 100.0));
+        Histogram_snapshotFree(&aSnapshot);
+
+        // free memory
+        Histogram_destroy(aLatencyPtr);
+        sBenchCounter_DUTs[aDut].mInterfacePtr->mDestroyPtr(aCounterPtr);
+        free(aCounterDriverThreadPtr);
+        free(aContextPtr);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Benchmark count-min sketch update throughput.
+ *
+ * Runs the sharded and the atomic sketch with the same workload, reporting
+ * the run-time of each hot run and the total count as a sanity check.
+ *
+ * @param iNumThreads Number of threads to run with.
+ * @param iArgsPtr Sketch shape, key space and run counts.
+ */
+uint32_t BenchCounter_benchSketch(uint32_t iNumThreads,
+                                  const tBenchCounter_sweepSketchArgs *iArgsPtr,
+                                  FILE *iOutputFilePtr)
+{
+    static const char *const sModeNames[] = {"count_min_sharded", "count_min_atomic"};
+    uint32_t aMode;
+    uint32_t aRun;
+    uint32_t aStatusCode;
+    uint32_t aThread;
+    double aT0;
+    double aT1;
+    pthread_t *aThreadPtr;
+    tBenchCounter_sketchContext *aContextPtr;
+    tCountMinSketch *aSketchPtr;
+    tCountMinSketch_options aOptions;
+
+    for (aMode = kCountMinSketch_modeSharded; aMode <= kCountMinSketch_modeAtomic; ++aMode)
+    {
+        // Allocate heap scratch
+        aThreadPtr = malloc(iNumThreads * sizeof(pthread_t));
+        assert(aThreadPtr != NULL);
+        aContextPtr = malloc(iNumThreads * sizeof(tBenchCounter_sketchContext));
+        assert(aContextPtr != NULL);
+
+        // Create sketch
+        aOptions.mThreads = iNumThreads;
+        aOptions.mDepth = iArgsPtr->mDepth;
+        aOptions.mWidth = iArgsPtr->mWidth;
+        aOptions.mMode = (tCountMinSketch_mode)aMode;
+        aSketchPtr = CountMinSketch_create(&aOptions);
+
+        for (aThread = 0; aThread < iNumThreads; ++aThread)
+        {
+            aContextPtr[aThread].mThread = aThread;
+            aContextPtr[aThread].mNumUpdates = iArgsPtr->mIncrements;
+            aContextPtr[aThread].mNumKeys = iArgsPtr->mKeys;
+            aContextPtr[aThread].mSketchPtr = aSketchPtr;
+        }
+
+        for (aRun = 0; aRun < iArgsPtr->mWarmups + iArgsPtr->mHotruns; ++aRun)
+        {
+            aT0 = now_ms();
+            for (aThread = 0; aThread < iNumThreads; ++aThread)
+            {
+                aStatusCode = pthread_create(&aThreadPtr[aThread], NULL, BenchCounter_sketchWorker,
+                                             &aContextPtr[aThread]);
+                assert(aStatusCode == 0);
+            }
+            for (aThread = 0; aThread < iNumThreads; ++aThread)
+            {
+                aStatusCode = pthread_join(aThreadPtr[aThread], NULL);
+                assert(aStatusCode == 0);
+            }
+            aT1 = now_ms();
+
+            if (aRun >= iArgsPtr->mWarmups)
+            {
+                fprintf(iOutputFilePtr, "%s,%u,%u,%u,%f,%llu\n", sModeNames[aMode], iNumThreads, iArgsPtr->mDepth,
+                        iArgsPtr->mWidth, aT1 - aT0, (unsigned long long)CountMinSketch_total(aSketchPtr));
+            }
+            CountMinSketch_reset(aSketchPtr);
+        }
+
+        // free memory
+        CountMinSketch_destroy(aSketchPtr);
+        free(aThreadPtr);
+        free(aContextPtr);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Benchmark shared-memory counters driven by threads and by processes.
+ *
+ * Runs every SharedCounter mode on an anonymous MAP_SHARED segment, once with
+ * pthread workers and once with forked worker processes, as a prefork server
+ * would. The process path includes the cost of fork() and waitpid(), which is
+ * why it is reported next to the threaded path over the same segment.
+ *
+ * @param iNumWorkers Number of threads or processes to run with.
+ * @param iArgsPtr Increment and run counts.
+ */
+uint32_t BenchCounter_benchShared(uint32_t iNumWorkers,
+                                  const tBenchCounter_sweepProcessesArgs *iArgsPtr,
+                                  FILE *iOutputFilePtr)
+{
+    static const char *const sModeNames[] = {"shared_sharded", "shared_atomic", "shared_locked"};
+    static const char *const sPathNames[] = {"thread", "process"};
+    uint32_t aMode;
+    uint32_t aPath;
+    uint32_t aRun;
+    uint32_t aStatusCode;
+    uint32_t aWorker;
+    uint64_t aCount;
+    double aT0;
+    double aT1;
+    int aChildStatus;
+    pthread_t *aThreadPtr;
+    pid_t *aChildPtr;
+    tBenchCounter_sharedContext *aContextPtr;
+    tSharedCounter *aCounterPtr;
+    tSharedCounter_options aOptions;
+
+    for (aMode = kSharedCounter_modeSharded; aMode <= kSharedCounter_modeLocked; ++aMode)
+    {
+        // Allocate heap scratch
+        aThreadPtr = malloc(iNumWorkers * sizeof(pthread_t));
+        assert(aThreadPtr != NULL);
+        aChildPtr = malloc(iNumWorkers * sizeof(pid_t));
+        assert(aChildPtr != NULL);
+        aContextPtr = malloc(iNumWorkers * sizeof(tBenchCounter_sharedContext));
+        assert(aContextPtr != NULL);
+
+        // Create the segment before any fork so the children inherit it
+        aOptions.mNamePtr = NULL;
+        aOptions.mWorkers = iNumWorkers;
+        aOptions.mCounters = 1;
+        aOptions.mMode = (tSharedCounter_mode)aMode;
+        aCounterPtr = SharedCounter_create(&aOptions);
+        assert(aCounterPtr != NULL);
+
+        for (aWorker = 0; aWorker < iNumWorkers; ++aWorker)
+        {
+            aContextPtr[aWorker].mWorker = aWorker;
+            aContextPtr[aWorker].mNumIncrements = iArgsPtr->mIncrements;
+            aContextPtr[aWorker].mCounterPtr = aCounterPtr;
+        }
+
+        for (aPath = 0; aPath < 2; ++aPath)
+        {
+            for (aRun = 0; aRun < iArgsPtr->mWarmups + iArgsPtr->mHotruns; ++aRun)
+            {
+                aT0 = now_ms();
+                if (aPath == 0)
+                {
+                    for (aWorker = 0; aWorker < iNumWorkers; ++aWorker)
+                    {
+                        aStatusCode = pthread_create(&aThreadPtr[aWorker], NULL, BenchCounter_sharedWorker,
+                                                     &aContextPtr[aWorker]);
+                        assert(aStatusCode == 0);
+                    }
+                    for (aWorker = 0; aWorker < iNumWorkers; ++aWorker)
+                    {
+                        aStatusCode = pthread_join(aThreadPtr[aWorker], NULL);
+                        assert(aStatusCode == 0);
+                    }
+                }
+                else
+                {
+                    for (aWorker = 0; aWorker < iNumWorkers; ++aWorker)
+                    {
+                        aChildPtr[aWorker] = fork();
+                        assert(aChildPtr[aWorker] >= 0);
+                        if (aChildPtr[aWorker] == 0)
+                        {
+                            BenchCounter_sharedWorker(&aContextPtr[aWorker]);
+                            _exit(0); // skip atexit handlers and stdio buffers inherited from the parent
+                        }
+                    }
+                    for (aWorker = 0; aWorker < iNumWorkers; ++aWorker)
+                    {
+                        waitpid(aChildPtr[aWorker], &aChildStatus, 0);
+                        assert(WIFEXITED(aChildStatus) && WEXITSTATUS(aChildStatus) == 0);
+                    }
+                }
+                aT1 = now_ms();
+
+                if (aRun >= iArgsPtr->mWarmups)
+                {
+                    SharedCounter_get(aCounterPtr, 0, &aCount);
+                    fprintf(iOutputFilePtr, "%s,%s,%u,%f,%llu\n", sModeNames[aMode], sPathNames[aPath], iNumWorkers,
+                            aT1 - aT0, (unsigned long long)aCount);
+                }
+                SharedCounter_reset(aCounterPtr);
+            }
+        }
+
+        // free memory
+        SharedCounter_destroy(aCounterPtr);
+        free(aThreadPtr);
+        free(aChildPtr);
+        free(aContextPtr);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Benchmark a CounterMap: per-key memory, update throughput and
+ *        exactness.
+ *
+ * The footprint inserts every key once from this thread and divides the
+ * growth of glibc's mallinfo2 in-use bytes by the number of keys, so the
+ * table and the per-thread caches are amortized over the keys. It is
+ * reported next to the footprint of one approximate_padded counter for the
+ * same threads (see BenchCounter_footprint), the cost of giving each key a
+ * counter instance of its own. After each hot run every key's count is
+ * compared with the count replayed from the workers' key streams.
+ *
+ * @param iNumKeys Number of distinct keys.
+ * @param iArgsPtr Thread count, threshold and run counts.
+ */
+uint32_t BenchCounter_benchMap(uint32_t iNumKeys,
+                               const tBenchCounter_sweepKeysArgs *iArgsPtr,
+                               FILE *iOutputFilePtr)
+{
+    uint32_t aRun;
+    uint32_t aStatusCode;
+    uint32_t aThread;
+    uint32_t aUpdate;
+    uint32_t aMismatches;
+    uint64_t aKey;
+    uint64_t aState;
+    uint64_t aCount;
+    uint64_t aTotal;
+    uint64_t *aExpectedPtr;
+    size_t aBytes;
+    size_t aCounterBytes;
+    double aT0;
+    double aT1;
+    pthread_t *aThreadPtr;
+    tBenchCounter_mapContext *aContextPtr;
+    tCounterMap *aMapPtr;
+    tCounterMap_options aOptions;
+    tBenchCounter_options aCounterOptions;
+
+    // Allocate heap scratch
+    aThreadPtr = malloc(iArgsPtr->mNumThreads * sizeof(pthread_t));
+    assert(aThreadPtr != NULL);
+    aContextPtr = malloc(iArgsPtr->mNumThreads * sizeof(tBenchCounter_mapContext));
+    assert(aContextPtr != NULL);
+    aExpectedPtr = calloc(iNumKeys, sizeof(uint64_t));
+    assert(aExpectedPtr != NULL);
+
+    aOptions.mThreads = iArgsPtr->mNumThreads;
+    aOptions.mBuckets = iNumKeys;
+    aOptions.mStripes = 0;
+    aOptions.mCacheSlots = 0;
+    aOptions.mThreshold = iArgsPtr->mThreshold;
+
+    // Per-key footprint of a map holding every key (large tables are mmapped)
+    aBytes = mallinfo2().uordblks + mallinfo2().hblkhd;
+    aMapPtr = CounterMap_create(&aOptions);
+    for (aKey = 0; aKey < iNumKeys; ++aKey)
+    {
+        CounterMap_add(aMapPtr, 0, &aKey, sizeof(aKey), 1);
+    }
+    CounterMap_flush(aMapPtr, 0);
+    aBytes = (mallinfo2().uordblks + mallinfo2().hblkhd - aBytes) / iNumKeys;
+    CounterMap_reset(aMapPtr);
+
+    aCounterBytes = BenchCounter_footprint(kBenchCounter_idxApproxPadded, iArgsPtr->mNumThreads,
+                                           BenchCounter_approxPaddedOptions(iArgsPtr->mNumThreads,
+                                                                            iArgsPtr->mThreshold,
+                                                                            kBenchCounter_relativeError,
+                                                                            &aCounterOptions));
+
+    // Replay the workers' key streams
+    for (aThread = 0; aThread < iArgsPtr->mNumThreads; ++aThread)
+    {
+        aContextPtr[aThread].mThread = aThread;
+        aContextPtr[aThread].mNumUpdates = iArgsPtr->mIncrements;
+        aContextPtr[aThread].mNumKeys = iNumKeys;
+        aContextPtr[aThread].mMapPtr = aMapPtr;
+
+        aState = 0x9e3779b97f4a7c15ull * (aThread + 1);
+        for (aUpdate = 0; aUpdate < iArgsPtr->mIncrements; ++aUpdate)
+        {
+            ++aExpectedPtr[BenchCounter_nextKey(&aState, iNumKeys)];
+        }
+    }
+
+    for (aRun = 0; aRun < iArgsPtr->mWarmups + iArgsPtr->mHotruns; ++aRun)
+    {
+        aT0 = now_ms();
+        for (aThread = 0; aThread < iArgsPtr->mNumThreads; ++aThread)
+        {
+            aStatusCode = pthread_create(&aThreadPtr[aThread], NULL, BenchCounter_mapWorker,
+                                         &aContextPtr[aThread]);
+            assert(aStatusCode == 0);
+        }
+        for (aThread = 0; aThread < iArgsPtr->mNumThreads; ++aThread)
+        {
+            aStatusCode = pthread_join(aThreadPtr[aThread], NULL);
+            assert(aStatusCode == 0);
+        }
+        aT1 = now_ms();
+
+        if (aRun >= iArgsPtr->mWarmups)
+        {
+            // every worker has flushed, so each count must be exact
+            aMismatches = 0;
+            aTotal = 0;
+            for (aKey = 0; aKey < iNumKeys; ++aKey)
+            {
+                aCount = CounterMap_get(aMapPtr, &aKey, sizeof(aKey));
+                aMismatches += (aCount != aExpectedPtr[aKey]);
+                aTotal += aCount;
+            }
+            fprintf(iOutputFilePtr, "counter_map,%u,%u,%u,%f,%llu,%u,%zu,%zu\n", iArgsPtr->mNumThreads, iNumKeys,
+                    iArgsPtr->mThreshold, aT1 - aT0, (unsigned long long)aTotal, aMismatches, aBytes, aCounterBytes);
+        }
+        CounterMap_reset(aMapPtr);
+    }
+
+    // free memory
+    CounterMap_destroy(aMapPtr);
+    free(aThreadPtr);
+    free(aContextPtr);
+    free(aExpectedPtr);
+
+    return 0;
+}
+
+/**
+ * @brief Create a timestamped benchmark folder and open a CSV file in it.
+ *
+ * @param iFilenamePtr Name of the CSV file within the folder.
+ * @param iHeaderPtr Header line written to the file (newline included).
+ * @param oFilepathPtr Buffer to write the path of the file to.
+ * @param iFilepathSize Size of the oFilepathPtr buffer.
+ * @return The open file, or NULL (with an error printed) on failure.
+ */
+static FILE *BenchCounter_openCsv(const char *iFilenamePtr,
+                                  const char *iHeaderPtr,
+                                  char *oFilepathPtr,
+                                  size_t iFilepathSize)
+{
+    // Get current wall-clock time for folder naming
+    time_t aRawtime;
+    struct tm *aTimeinfoPtr;
+    char aTimestamp[64];
+    char aFolderName[128];
+    FILE *aOutputFilePtr;
+
+    time(&aRawtime);
+    aTimeinfoPtr = localtime(&aRawtime);
+    strftime(aTimestamp, sizeof(aTimestamp), "%Y%m%d_%H%M%S", aTimeinfoPtr);
+
+    // Create benchmark folder
+    snprintf(aFolderName, sizeof(aFolderName), "benchmark_%s", aTimestamp);
+    if (mkdir(aFolderName, 0755) != 0)
+    {
+        perror("Failed to create benchmark directory");
+        return NULL;
+    }
+    snprintf(oFilepathPtr, iFilepathSize, "%s/%s", aFolderName, iFilenamePtr);
+
+    // Open CSV file for writing
+    aOutputFilePtr = fopen(oFilepathPtr, "w");
+    if (aOutputFilePtr == NULL)
+    {
+        perror("Failed to create output file");
+        return NULL;
+    }
+
+    // Write CSV header
+    fputs(iHeaderPtr, aOutputFilePtr);
+    return aOutputFilePtr;
+}
+
+/**
+ * @brief Execute sweep_threads subcommand.
+ *
+ * Sweeps across different thread counts while keeping threshold constant.
+ */
+int BenchCounter_sweepThreads(const tBenchCounter_sweepThreadsArgs *iArgsPtr)
+{
+    char aFilename[256];
+    char aFilepath[384];
+    FILE *aOutputFilePtr;
+
+    // Create CSV filename for thread sweep
+    snprintf(aFilename, sizeof(aFilename), "sweep_threads_threshold%u_increments%u_warmups%u_hotruns%u.csv",
+             iArgsPtr->mThreshold, iArgsPtr->mIncrements, iArgsPtr->mWarmups, iArgsPtr->mHotruns);
+    aOutputFilePtr = BenchCounter_openCsv(aFilename, kBenchCounter_counterCsvHeader, aFilepath, sizeof(aFilepath));
+    if (aOutputFilePtr == NULL)
+    {
+        return 1;
+    }
 
     // Run parameter sweep across different thread counts
     for (uint32_t aThreads = iArgsPtr->mMinThreads; aThreads <= iArgsPtr->mMaxThreads; aThreads += iArgsPtr->mStep)
     {
         printf("Running benchmark with %u threads...\n", aThreads);
-        BenchCounter_benchApproximateCounter(aThreads, iArgsPtr->mThreshold, iArgsPtr->mIncrements,
+        BenchCounter_benchApproximateCounter(kBenchCounter_allDUTs, aThreads, iArgsPtr->mThreshold, kBenchCounter_relativeError, iArgsPtr->mIncrements, 0,
                                              iArgsPtr->mWarmups, iArgsPtr->mHotruns, aOutputFilePtr);
         fflush(aOutputFilePtr); // Ensure data is written after each run
     }
@@ -323,114 +1399,642 @@ int BenchCounter_sweepThreads(const tBenchCounter_sweepThreadsArgs *iArgsPtr)
 }
 
 /**
- * @brief Execute sweep_threshold subcommand.
+ * @brief Execute sweep_latency subcommand.
  *
- * Sweeps across different threshold values while keeping thread count constant.
+ * Sweeps across different thread counts like sweep_threads, reporting the
+ * per-increment latency distribution instead of the total run-time.
  */
-int BenchCounter_sweepThreshold(const tBenchCounter_sweepThresholdArgs *iArgsPtr)
+int BenchCounter_sweepLatency(const tBenchCounter_sweepThreadsArgs *iArgsPtr)
 {
-    // Get current wall-clock time for folder and file naming
-    time_t aRawtime;
-    struct tm *aTimeinfoPtr;
-    char aTimestamp[64];
-    char aFolderName[128];
     char aFilename[256];
     char aFilepath[384];
     FILE *aOutputFilePtr;
 
-    time(&aRawtime);
-    aTimeinfoPtr = localtime(&aRawtime);
-    strftime(aTimestamp, sizeof(aTimestamp), "%Y%m%d_%H%M%S", aTimeinfoPtr);
+    // Create CSV filename for latency sweep
+    snprintf(aFilename, sizeof(aFilename), "sweep_latency_threshold%u_increments%u_warmups%u_hotruns%u.csv",
+             iArgsPtr->mThreshold, iArgsPtr->mIncrements, iArgsPtr->mWarmups, iArgsPtr->mHotruns);
+    aOutputFilePtr = BenchCounter_openCsv(aFilename,
+                                          "counter,n_threads,threshold,samples,p50 (ns),p90 (ns),p99 (ns),p99.9 (ns),max (ns)\n",
+                                          aFilepath, sizeof(aFilepath));
+    if (aOutputFilePtr == NULL)
+    {
+        return 1;
+    }
+
+    // Run parameter sweep across different thread counts
+    for (uint32_t aThreads = iArgsPtr->mMinThreads; aThreads <= iArgsPtr->mMaxThreads; aThreads += iArgsPtr->mStep)
+    {
+        printf("Running latency benchmark with %u threads...\n", aThreads);
+        BenchCounter_benchLatency(kBenchCounter_allDUTs, aThreads, iArgsPtr->mThreshold, iArgsPtr->mIncrements,
+                                  iArgsPtr->mWarmups, iArgsPtr->mHotruns, aOutputFilePtr);
+        fflush(aOutputFilePtr); // Ensure data is written after each run
+    }
+
+    // Close file and cleanup
+    fclose(aOutputFilePtr);
+
+    printf("Latency sweep completed. Results written to: %s\n", aFilepath);
+    return 0;
+}
+
+/**
+ * @brief Execute sweep_sketch subcommand.
+ *
+ * Sweeps across different thread counts, measuring count-min sketch update
+ * throughput with sharded tables and with one shared atomic table.
+ */
+int BenchCounter_sweepSketch(const tBenchCounter_sweepSketchArgs *iArgsPtr)
+{
+    char aFilename[256];
+    char aFilepath[384];
+    FILE *aOutputFilePtr;
+
+    // Create CSV filename for sketch sweep
+    snprintf(aFilename, sizeof(aFilename), "sweep_sketch_depth%u_width%u_keys%u_increments%u_warmups%u_hotruns%u.csv",
+             iArgsPtr->mDepth, iArgsPtr->mWidth, iArgsPtr->mKeys, iArgsPtr->mIncrements, iArgsPtr->mWarmups,
+             iArgsPtr->mHotruns);
+    aOutputFilePtr = BenchCounter_openCsv(aFilename,
+                                          "sketch,n_threads,depth,width,time (ms),final_count\n",
+                                          aFilepath, sizeof(aFilepath));
+    if (aOutputFilePtr == NULL)
+    {
+        return 1;
+    }
+
+    // Run parameter sweep across different thread counts
+    for (uint32_t aThreads = iArgsPtr->mMinThreads; aThreads <= iArgsPtr->mMaxThreads; aThreads += iArgsPtr->mStep)
+    {
+        printf("Running sketch benchmark with %u threads...\n", aThreads);
+        BenchCounter_benchSketch(aThreads, iArgsPtr, aOutputFilePtr);
+        fflush(aOutputFilePtr); // Ensure data is written after each run
+    }
+
+    // Close file and cleanup
+    fclose(aOutputFilePtr);
+
+    printf("Sketch sweep completed. Results written to: %s\n", aFilepath);
+    return 0;
+}
+
+/**
+ * @brief Execute sweep_processes subcommand.
+ *
+ * Sweeps across different worker counts, comparing shared-memory counters
+ * updated by forked processes with the same counters updated by threads.
+ */
+int BenchCounter_sweepProcesses(const tBenchCounter_sweepProcessesArgs *iArgsPtr)
+{
+    char aFilename[256];
+    char aFilepath[384];
+    FILE *aOutputFilePtr;
+
+    // Create CSV filename for process sweep
+    snprintf(aFilename, sizeof(aFilename), "sweep_processes_increments%u_warmups%u_hotruns%u.csv",
+             iArgsPtr->mIncrements, iArgsPtr->mWarmups, iArgsPtr->mHotruns);
+    aOutputFilePtr = BenchCounter_openCsv(aFilename,
+                                          "counter,path,n_workers,time (ms),final_count\n",
+                                          aFilepath, sizeof(aFilepath));
+    if (aOutputFilePtr == NULL)
+    {
+        return 1;
+    }
+
+    // Run parameter sweep across different worker counts
+    for (uint32_t aWorkers = iArgsPtr->mMinWorkers; aWorkers <= iArgsPtr->mMaxWorkers; aWorkers += iArgsPtr->mStep)
+    {
+        printf("Running shared-memory benchmark with %u workers...\n", aWorkers);
+        fflush(stdout); // don't let forked children inherit pending output
+        BenchCounter_benchShared(aWorkers, iArgsPtr, aOutputFilePtr);
+        fflush(aOutputFilePtr); // Ensure data is written after each run
+    }
+
+    // Close file and cleanup
+    fclose(aOutputFilePtr);
+
+    printf("Process sweep completed. Results written to: %s\n", aFilepath);
+    return 0;
+}
+
+/**
+ * @brief Execute sweep_keys subcommand.
+ *
+ * Sweeps across different key counts, measuring CounterMap per-key memory,
+ * update throughput and the exactness of the flushed counts.
+ */
+int BenchCounter_sweepKeys(const tBenchCounter_sweepKeysArgs *iArgsPtr)
+{
+    char aFilename[256];
+    char aFilepath[384];
+    FILE *aOutputFilePtr;
+    uint32_t aKeys;
+
+    // Create CSV filename for key sweep
+    snprintf(aFilename, sizeof(aFilename), "sweep_keys_threads%u_threshold%u_increments%u_warmups%u_hotruns%u.csv",
+             iArgsPtr->mNumThreads, iArgsPtr->mThreshold, iArgsPtr->mIncrements, iArgsPtr->mWarmups,
+             iArgsPtr->mHotruns);
+    aOutputFilePtr = BenchCounter_openCsv(aFilename,
+                                          "counter,n_threads,keys,threshold,time (ms),final_count,mismatched_keys,"
+                                          "bytes_per_key (glibc mallinfo2),bytes_per_counter (glibc mallinfo2)\n",
+                                          aFilepath, sizeof(aFilepath));
+    if (aOutputFilePtr == NULL)
+    {
+        return 1;
+    }
+
+    // Run parameter sweep across different key counts
+    aKeys = iArgsPtr->mStartKeys;
+    for (uint32_t aStep = 0; aStep < iArgsPtr->mSteps; ++aStep)
+    {
+        printf("Running counter map benchmark with %u keys...\n", aKeys);
+        BenchCounter_benchMap(aKeys, iArgsPtr, aOutputFilePtr);
+        fflush(aOutputFilePtr); // Ensure data is written after each run
+        aKeys *= 2;
+    }
+
+    // Close file and cleanup
+    fclose(aOutputFilePtr);
+
+    printf("Key sweep completed. Results written to: %s\n", aFilepath);
+    return 0;
+}
+
+/**
+ * @brief Execute sweep_threshold subcommand.
+ *
+ * Sweeps across different threshold values while keeping thread count constant.
+ */
+int BenchCounter_sweepThreshold(const tBenchCounter_sweepThresholdArgs *iArgsPtr)
+{
+    char aFilename[256];
+    char aFilepath[384];
+    FILE *aOutputFilePtr;
+
+    // Create CSV filename for threshold sweep
+    snprintf(aFilename, sizeof(aFilename), "sweep_threshold_threads%u_increments%u_warmups%u_hotruns%u.csv",
+             iArgsPtr->mNumThreads, iArgsPtr->mIncrements, iArgsPtr->mWarmups, iArgsPtr->mHotruns);
+    aOutputFilePtr = BenchCounter_openCsv(aFilename, kBenchCounter_counterCsvHeader, aFilepath, sizeof(aFilepath));
+    if (aOutputFilePtr == NULL)
+    {
+        return 1;
+    }
+
+    // Run parameter sweep across different threshold values
+    uint32_t aThreshold = iArgsPtr->mStartThreshold;
+    for (uint32_t aStep = 0; aStep < iArgsPtr->mSteps; ++aStep)
+    {
+        printf("Running benchmark with threshold %u...\n", aThreshold);
+        BenchCounter_benchApproximateCounter(kBenchCounter_allDUTs, iArgsPtr->mNumThreads, aThreshold, kBenchCounter_relativeError, iArgsPtr->mIncrements, 0,
+                                             iArgsPtr->mWarmups, iArgsPtr->mHotruns, aOutputFilePtr);
+        fflush(aOutputFilePtr); // Ensure data is written after each run
+        aThreshold *= 2;        // Multiply by 2 for next step
+    }
+
+    // Close file and cleanup
+    fclose(aOutputFilePtr);
+
+    printf("Threshold sweep completed. Results written to: %s\n", aFilepath);
+    return 0;
+}
+
+/**
+ * @brief Execute sweep_reads subcommand.
+ *
+ * Sweeps across different read intervals while keeping thread count and
+ * threshold constant. Shows where counters with cheap increments and costly
+ * reads (e.g. summing) cross over counters with a cheap read.
+ */
+int BenchCounter_sweepReads(const tBenchCounter_sweepReadsArgs *iArgsPtr)
+{
+    char aFilename[256];
+    char aFilepath[384];
+    FILE *aOutputFilePtr;
+
+    // Create CSV filename for read interval sweep
+    snprintf(aFilename, sizeof(aFilename), "sweep_reads_threads%u_threshold%u_increments%u_warmups%u_hotruns%u.csv",
+             iArgsPtr->mNumThreads, iArgsPtr->mThreshold, iArgsPtr->mIncrements, iArgsPtr->mWarmups, iArgsPtr->mHotruns);
+    aOutputFilePtr = BenchCounter_openCsv(aFilename, kBenchCounter_counterCsvHeader, aFilepath, sizeof(aFilepath));
+    if (aOutputFilePtr == NULL)
+    {
+        return 1;
+    }
+
+    // Run parameter sweep across different read intervals
+    uint32_t aInterval = iArgsPtr->mStartInterval;
+    for (uint32_t aStep = 0; aStep < iArgsPtr->mSteps; ++aStep)
+    {
+        printf("Running benchmark with read interval %u...\n", aInterval);
+        BenchCounter_benchApproximateCounter(kBenchCounter_allDUTs, iArgsPtr->mNumThreads, iArgsPtr->mThreshold, kBenchCounter_relativeError, iArgsPtr->mIncrements, aInterval,
+                                             iArgsPtr->mWarmups, iArgsPtr->mHotruns, aOutputFilePtr);
+        fflush(aOutputFilePtr); // Ensure data is written after each run
+        aInterval *= 2;         // Multiply by 2 for next step
+    }
+
+    // Close file and cleanup
+    fclose(aOutputFilePtr);
+
+    printf("Read interval sweep completed. Results written to: %s\n", aFilepath);
+    return 0;
+}
+
+/**
+ * @brief Execute sweep_error subcommand.
+ *
+ * Sweeps across target relative errors, comparing the estimating counters at
+ * equal accuracy. ApproximateCounter can be off by up to mThreshold per thread
+ * before the final flush, so its threshold is set to error * increments.
+ */
+int BenchCounter_sweepError(const tBenchCounter_sweepErrorArgs *iArgsPtr)
+{
+    char aFilename[256];
+    char aFilepath[384];
+    FILE *aOutputFilePtr;
+
+    // Create CSV filename for relative error sweep
+    snprintf(aFilename, sizeof(aFilename), "sweep_error_threads%u_increments%u_warmups%u_hotruns%u.csv",
+             iArgsPtr->mNumThreads, iArgsPtr->mIncrements, iArgsPtr->mWarmups, iArgsPtr->mHotruns);
+    aOutputFilePtr = BenchCounter_openCsv(aFilename, kBenchCounter_counterCsvHeader, aFilepath, sizeof(aFilepath));
+    if (aOutputFilePtr == NULL)
+    {
+        return 1;
+    }
+
+    // Run parameter sweep across different relative errors
+    double aError = iArgsPtr->mStartError;
+    for (uint32_t aStep = 0; aStep < iArgsPtr->mSteps; ++aStep)
+    {
+        uint32_t aThreshold = (uint32_t)(aError * iArgsPtr->mIncrements);
+        if (aThreshold == 0)
+        {
+            aThreshold = 1;
+        }
+
+        printf("Running benchmark with relative error %f...\n", aError);
+        BenchCounter_benchApproximateCounter((1u << kBenchCounter_idxApprox) |
+                                                 (1u << kBenchCounter_idxApproxOwner) |
+                                                 (1u << kBenchCounter_idxProbabilistic),
+                                             iArgsPtr->mNumThreads, aThreshold, aError, iArgsPtr->mIncrements, 0,
+                                             iArgsPtr->mWarmups, iArgsPtr->mHotruns, aOutputFilePtr);
+        fflush(aOutputFilePtr); // Ensure data is written after each run
+        aError /= 2;            // Halve for next step
+    }
+
+    // Close file and cleanup
+    fclose(aOutputFilePtr);
+
+    printf("Relative error sweep completed. Results written to: %s\n", aFilepath);
+    return 0;
+}
+
+/**
+ * @brief Print usage information.
+ */
+void BenchCounter_printUsage(const char *aProgramNamePtr)
+{
+    printf("Usage: %s <subcommand> [options]\n\n", aProgramNamePtr);
+    printf("Subcommands:\n");
+    printf("  sweep_threads   - Sweep across different thread counts\n");
+    printf("  sweep_threshold - Sweep across different threshold values\n");
+    printf("  sweep_reads     - Sweep across different read intervals\n");
+    printf("  sweep_error     - Sweep estimating counters across target relative errors\n");
+    printf("  sweep_latency   - Sweep thread counts, recording per-increment latency percentiles\n");
+    printf("  sweep_sketch    - Sweep thread counts for count-min sketch update throughput\n");
+    printf("  sweep_processes - Sweep worker counts for shared-memory counters, processes vs threads\n");
+    printf("  sweep_keys      - Sweep key counts for counter map memory, throughput and exactness\n\n");
+
+    printf("sweep_threads and sweep_latency options:\n");
+    printf("  --min-threads <n>    Minimum number of threads (default: 1)\n");
+    printf("  --max-threads <n>    Maximum number of threads (default: 16)\n");
+    printf("  --step <n>           Step size for thread increments (default: 1)\n");
+    printf("  --threshold <n>      Threshold for approximate counter (default: 4096)\n");
+    printf("  --increments <n>     Number of increments per thread (default: 100000)\n");
+    printf("  --warmups <n>        Number of warmup runs (default: 15)\n");
+    printf("  --hotruns <n>        Number of hot runs (default: 30)\n\n");
+
+    printf("sweep_threshold options:\n");
+    printf("  --num-threads <n>      Number of threads (constant) (default: 8)\n");
+    printf("  --start-threshold <n>  Starting threshold value (default: 1)\n");
+    printf("  --steps <n>            Number of threshold steps (default: 16)\n");
+    printf("  --increments <n>       Number of increments per thread (default: 100000)\n");
+    printf("  --warmups <n>          Number of warmup runs (default: 15)\n");
+    printf("  --hotruns <n>          Number of hot runs (default: 30)\n\n");
+
+    printf("sweep_reads options:\n");
+    printf("  --num-threads <n>     Number of threads (constant) (default: 8)\n");
+    printf("  --threshold <n>       Threshold for approximate counter (default: 4096)\n");
+    printf("  --start-interval <n>  Starting read interval in increments (default: 1)\n");
+    printf("  --steps <n>           Number of read interval steps (default: 21)\n");
+    printf("  --increments <n>      Number of increments per thread (default: 100000)\n");
+    printf("  --warmups <n>         Number of warmup runs (default: 15)\n");
+    printf("  --hotruns <n>         Number of hot runs (default: 30)\n\n");
+
+    printf("sweep_error options:\n");
+    printf("  --num-threads <n>   Number of threads (constant) (default: 8)\n");
+    printf("  --start-error <x>   Starting relative error (default: 0.16)\n");
+    printf("  --steps <n>         Number of relative error steps (default: 6)\n");
+    printf("  --increments <n>    Number of increments per thread (default: 100000)\n");
+    printf("  --warmups <n>       Number of warmup runs (default: 15)\n");
+    printf("  --hotruns <n>       Number of hot runs (default: 30)\n\n");
+
+    printf("sweep_sketch options:\n");
+    printf("  --min-threads <n>    Minimum number of threads (default: 1)\n");
+    printf("  --max-threads <n>    Maximum number of threads (default: 16)\n");
+    printf("  --step <n>           Step size for thread increments (default: 1)\n");
+    printf("  --depth <n>          Sketch rows (default: 4)\n");
+    printf("  --width <n>          Sketch counters per row (default: 4096)\n");
+    printf("  --keys <n>           Size of the key space (default: 1000000)\n");
+    printf("  --increments <n>     Number of updates per thread (default: 100000)\n");
+    printf("  --warmups <n>        Number of warmup runs (default: 15)\n");
+    printf("  --hotruns <n>        Number of hot runs (default: 30)\n\n");
+
+    printf("sweep_processes options:\n");
+    printf("  --min-workers <n>    Minimum number of workers (default: 1)\n");
+    printf("  --max-workers <n>    Maximum number of workers (default: 16)\n");
+    printf("  --step <n>           Step size for worker increments (default: 1)\n");
+    printf("  --increments <n>     Number of increments per worker (default: 100000)\n");
+    printf("  --warmups <n>        Number of warmup runs (default: 15)\n");
+    printf("  --hotruns <n>        Number of hot runs (default: 30)\n\n");
+
+    printf("sweep_keys options:\n");
+    printf("  --num-threads <n>    Number of threads (constant) (default: 8)\n");
+    printf("  --threshold <n>      Per-thread delta at which a key is flushed (default: 64)\n");
+    printf("  --start-keys <n>     Starting number of keys (default: 1024)\n");
+    printf("  --steps <n>          Number of key count steps (default: 8)\n");
+    printf("  --increments <n>     Number of updates per thread (default: 100000)\n");
+    printf("  --warmups <n>        Number of warmup runs (default: 15)\n");
+    printf("  --hotruns <n>        Number of hot runs (default: 30)\n");
+}
+
+int main(int argc, char **argv)
+{
+    printf("Welcome to Concurrent Counter Driver\n");
+
+    if (argc < 2)
+    {
+        BenchCounter_printUsage(argv[0]);
+        return 1;
+    }
+
+    const char *aSubcommandPtr = argv[1];
+
+    if (strcmp(aSubcommandPtr, "sweep_threads") == 0 || strcmp(aSubcommandPtr, "sweep_latency") == 0)
+    {
+        tBenchCounter_sweepThreadsArgs aArgs = {
+            .mMinThreads = 1,
+            .mMaxThreads = 16,
+            .mStep = 1,
+            .mThreshold = 4096,
+            .mIncrements = 100000,
+            .mWarmups = 15,
+            .mHotruns = 30};
+
+        static struct option aLongOptions[] = {
+            {"min-threads", required_argument, 0, 0},
+            {"max-threads", required_argument, 0, 1},
+            {"step", required_argument, 0, 2},
+            {"threshold", required_argument, 0, 3},
+            {"increments", required_argument, 0, 4},
+            {"warmups", required_argument, 0, 5},
+            {"hotruns", required_argument, 0, 6},
+            {"help", no_argument, 0, 'h'},
+            {0, 0, 0, 0}};
+
+        int aOptionIndex = 0;
+        int aC;
+        optind = 2; // Skip program name and subcommand
+
+        while ((aC = getopt_long(argc, argv, "h", aLongOptions, &aOptionIndex)) != -1)
+        {
+            switch (aC)
+            {
+            case 0:
+                aArgs.mMinThreads = (uint32_t)atoi(optarg);
+                break;
+            case 1:
+                aArgs.mMaxThreads = (uint32_t)atoi(optarg);
+                break;
+            case 2:
+                aArgs.mStep = (uint32_t)atoi(optarg);
+                break;
+            case 3:
+                aArgs.mThreshold = (uint32_t)atoi(optarg);
+                break;
+            case 4:
+                aArgs.mIncrements = (uint32_t)atoi(optarg);
+                break;
+            case 5:
+                aArgs.mWarmups = (uint32_t)atoi(optarg);
+                break;
+            case 6:
+                aArgs.mHotruns = (uint32_t)atoi(optarg);
+                break;
+            case 'h':
+                BenchCounter_printUsage(argv[0]);
+                return 0;
+            case '?':
+                BenchCounter_printUsage(argv[0]);
+                return 1;
+            default:
+                break;
+            }
+        }
+
+        if (strcmp(aSubcommandPtr, "sweep_latency") == 0)
+        {
+            return BenchCounter_sweepLatency(&aArgs);
+        }
+        return BenchCounter_sweepThreads(&aArgs);
+    }
+    else if (strcmp(aSubcommandPtr, "sweep_threshold") == 0)
+    {
+        tBenchCounter_sweepThresholdArgs aArgs = {
+            .mNumThreads = 8,
+            .mStartThreshold = 1,
+            .mSteps = 16,
+            .mIncrements = 100000,
+            .mWarmups = 15,
+            .mHotruns = 30};
+
+        static struct option aLongOptions[] = {
+            {"num-threads", required_argument, 0, 0},
+            {"start-threshold", required_argument, 0, 1},
+            {"steps", required_argument, 0, 2},
+            {"increments", required_argument, 0, 3},
+            {"warmups", required_argument, 0, 4},
+            {"hotruns", required_argument, 0, 5},
+            {"help", no_argument, 0, 'h'},
+            {0, 0, 0, 0}};
+
+        int aOptionIndex = 0;
+        int aC;
+        optind = 2; // Skip program name and subcommand
+
+        while ((aC = getopt_long(argc, argv, "h", aLongOptions, &aOptionIndex)) != -1)
+        {
+            switch (aC)
+            {
+            case 0:
+                aArgs.mNumThreads = (uint32_t)atoi(optarg);
+                break;
+            case 1:
+                aArgs.mStartThreshold = (uint32_t)atoi(optarg);
+                break;
+            case 2:
+                aArgs.mSteps = (uint32_t)atoi(optarg);
+                break;
+            case 3:
+                aArgs.mIncrements = (uint32_t)atoi(optarg);
+                break;
+            case 4:
+                aArgs.mWarmups = (uint32_t)atoi(optarg);
+                break;
+            case 5:
+                aArgs.mHotruns = (uint32_t)atoi(optarg);
+                break;
+            case 'h':
+                BenchCounter_printUsage(argv[0]);
+                return 0;
+            case '?':
+                BenchCounter_printUsage(argv[0]);
+                return 1;
+            default:
+                break;
+            }
+        }
 
-    // Create benchmark folder
-    snprintf(aFolderName, sizeof(aFolderName), "benchmark_%s", aTimestamp);
-    if (mkdir(aFolderName, 0755) != 0)
-    {
-        perror("Failed to create benchmark directory");
-        return 1;
+        return BenchCounter_sweepThreshold(&aArgs);
     }
-
-    // Create CSV filename for threshold sweep
-    snprintf(aFilename, sizeof(aFilename), "sweep_threshold_threads%u_increments%u_warmups%u_hotruns%u.csv",
-             iArgsPtr->mNumThreads, iArgsPtr->mIncrements, iArgsPtr->mWarmups, iArgsPtr->mHotruns);
-    snprintf(aFilepath, sizeof(aFilepath), "%s/%s", aFolderName, aFilename);
-
-    // Open CSV file for writing
-    aOutputFilePtr = fopen(aFilepath, "w");
-    if (aOutputFilePtr == NULL)
+    else if (strcmp(aSubcommandPtr, "sweep_reads") == 0)
     {
-        perror("Failed to create output file");
-        return 1;
-    }
-
-    // Write CSV header
-    fprintf(aOutputFilePtr, "counter,n_threads,threshold,time (ms),final_count\n");
+        tBenchCounter_sweepReadsArgs aArgs = {
+            .mNumThreads = 8,
+            .mThreshold = 4096,
+            .mStartInterval = 1,
+            .mSteps = 21,
+            .mIncrements = 100000,
+            .mWarmups = 15,
+            .mHotruns = 30};
 
-    // Run parameter sweep across different threshold values
-    uint32_t aThreshold = iArgsPtr->mStartThreshold;
-    for (uint32_t aStep = 0; aStep < iArgsPtr->mSteps; ++aStep)
-    {
-        printf("Running benchmark with threshold %u...\n", aThreshold);
-        BenchCounter_benchApproximateCounter(iArgsPtr->mNumThreads, aThreshold, iArgsPtr->mIncrements,
-                                             iArgsPtr->mWarmups, iArgsPtr->mHotruns, aOutputFilePtr);
-        fflush(aOutputFilePtr); // Ensure data is written after each run
-        aThreshold *= 2;        // Multiply by 2 for next step
-    }
+        static struct option aLongOptions[] = {
+            {"num-threads", required_argument, 0, 0},
+            {"threshold", required_argument, 0, 1},
+            {"start-interval", required_argument, 0, 2},
+            {"steps", required_argument, 0, 3},
+            {"increments", required_argument, 0, 4},
+            {"warmups", required_argument, 0, 5},
+            {"hotruns", required_argument, 0, 6},
+            {"help", no_argument, 0, 'h'},
+            {0, 0, 0, 0}};
 
-    // Close file and cleanup
-    fclose(aOutputFilePtr);
+        int aOptionIndex = 0;
+        int aC;
+        optind = 2; // Skip program name and subcommand
 
-    printf("Threshold sweep completed. Results written to: %s\n", aFilepath);
-    return 0;
-}
+        while ((aC = getopt_long(argc, argv, "h", aLongOptions, &aOptionIndex)) != -1)
+        {
+            switch (aC)
+            {
+            case 0:
+                aArgs.mNumThreads = (uint32_t)atoi(optarg);
+                break;
+            case 1:
+                aArgs.mThreshold = (uint32_t)atoi(optarg);
+                break;
+            case 2:
+                aArgs.mStartInterval = (uint32_t)atoi(optarg);
+                break;
+            case 3:
+                aArgs.mSteps = (uint32_t)atoi(optarg);
+                break;
+            case 4:
+                aArgs.mIncrements = (uint32_t)atoi(optarg);
+                break;
+            case 5:
+                aArgs.mWarmups = (uint32_t)atoi(optarg);
+                break;
+            case 6:
+                aArgs.mHotruns = (uint32_t)atoi(optarg);
+                break;
+            case 'h':
+                BenchCounter_printUsage(argv[0]);
+                return 0;
+            case '?':
+                BenchCounter_printUsage(argv[0]);
+                return 1;
+            default:
+                break;
+            }
+        }
 
-/**
- * @brief Print usage information.
- */
-void BenchCounter_printUsage(const char *aProgramNamePtr)
-{
-    printf("Usage: %s <subcommand> [options]\n\n", aProgramNamePtr);
-    printf("Subcommands:\n");
-    printf("  sweep_threads   - Sweep across different thread counts\n");
-    printf("  sweep_threshold - Sweep across different threshold values\n\n");
+        return BenchCounter_sweepReads(&aArgs);
+    }
+    else if (strcmp(aSubcommandPtr, "sweep_error") == 0)
+    {
+        tBenchCounter_sweepErrorArgs aArgs = {
+            .mNumThreads = 8,
+            .mStartError = 0.16,
+            .mSteps = 6,
+            .mIncrements = 100000,
+            .mWarmups = 15,
+            .mHotruns = 30};
 
-    printf("sweep_threads options:\n");
-    printf("  --min-threads <n>    Minimum number of threads (default: 1)\n");
-    printf("  --max-threads <n>    Maximum number of threads (default: 16)\n");
-    printf("  --step <n>           Step size for thread increments (default: 1)\n");
-    printf("  --threshold <n>      Threshold for approximate counter (default: 4096)\n");
-    printf("  --increments <n>     Number of increments per thread (default: 100000)\n");
-    printf("  --warmups <n>        Number of warmup runs (default: 15)\n");
-    printf("  --hotruns <n>        Number of hot runs (default: 30)\n\n");
+        static struct option aLongOptions[] = {
+            {"num-threads", required_argument, 0, 0},
+            {"start-error", required_argument, 0, 1},
+            {"steps", required_argument, 0, 2},
+            {"increments", required_argument, 0, 3},
+            {"warmups", required_argument, 0, 4},
+            {"hotruns", required_argument, 0, 5},
+            {"help", no_argument, 0, 'h'},
+            {0, 0, 0, 0}};
 
-    printf("sweep_threshold options:\n");
-    printf("  --num-threads <n>      Number of threads (constant) (default: 8)\n");
-    printf("  --start-threshold <n>  Starting threshold value (default: 1)\n");
-    printf("  --steps <n>            Number of threshold steps (default: 16)\n");
-    printf("  --increments <n>       Number of increments per thread (default: 100000)\n");
-    printf("  --warmups <n>          Number of warmup runs (default: 15)\n");
-    printf("  --hotruns <n>          Number of hot runs (default: 30)\n");
-}
+        int aOptionIndex = 0;
+        int aC;
+        optind = 2; // Skip program name and subcommand
 
-int main(int argc, char **argv)
-{
-    printf("Welcome to Concurrent Counter Driver\n");
+        while ((aC = getopt_long(argc, argv, "h", aLongOptions, &aOptionIndex)) != -1)
+        {
+            switch (aC)
+            {
+            case 0:
+                aArgs.mNumThreads = (uint32_t)atoi(optarg);
+                break;
+            case 1:
+                aArgs.mStartError = atof(optarg);
+                break;
+            case 2:
+                aArgs.mSteps = (uint32_t)atoi(optarg);
+                break;
+            case 3:
+                aArgs.mIncrements = (uint32_t)atoi(optarg);
+                break;
+            case 4:
+                aArgs.mWarmups = (uint32_t)atoi(optarg);
+                break;
+            case 5:
+                aArgs.mHotruns = (uint32_t)atoi(optarg);
+                break;
+            case 'h':
+                BenchCounter_printUsage(argv[0]);
+                return 0;
+            case '?':
+                BenchCounter_printUsage(argv[0]);
+                return 1;
+            default:
+                break;
+            }
+        }
 
-    if (argc < 2)
-    {
-        BenchCounter_printUsage(argv[0]);
-        return 1;
+        return BenchCounter_sweepError(&aArgs);
     }
-
-    const char *aSubcommandPtr = argv[1];
-
-    if (strcmp(aSubcommandPtr, "sweep_threads") == 0)
+    else if (strcmp(aSubcommandPtr, "sweep_sketch") == 0)
     {
-        tBenchCounter_sweepThreadsArgs aArgs = {
+        tBenchCounter_sweepSketchArgs aArgs = {
             .mMinThreads = 1,
             .mMaxThreads = 16,
             .mStep = 1,
-            .mThreshold = 4096,
+            .mDepth = 4,
+            .mWidth = 4096,
+            .mKeys = 1000000,
             .mIncrements = 100000,
             .mWarmups = 15,
             .mHotruns = 30};
@@ -439,10 +2043,12 @@ int main(int argc, char **argv)
             {"min-threads", required_argument, 0, 0},
             {"max-threads", required_argument, 0, 1},
             {"step", required_argument, 0, 2},
-            {"threshold", required_argument, 0, 3},
-            {"increments", required_argument, 0, 4},
-            {"warmups", required_argument, 0, 5},
-            {"hotruns", required_argument, 0, 6},
+            {"depth", required_argument, 0, 3},
+            {"width", required_argument, 0, 4},
+            {"keys", required_argument, 0, 5},
+            {"increments", required_argument, 0, 6},
+            {"warmups", required_argument, 0, 7},
+            {"hotruns", required_argument, 0, 8},
             {"help", no_argument, 0, 'h'},
             {0, 0, 0, 0}};
 
@@ -464,15 +2070,21 @@ int main(int argc, char **argv)
                 aArgs.mStep = (uint32_t)atoi(optarg);
                 break;
             case 3:
-                aArgs.mThreshold = (uint32_t)atoi(optarg);
+                aArgs.mDepth = (uint32_t)atoi(optarg);
                 break;
             case 4:
-                aArgs.mIncrements = (uint32_t)atoi(optarg);
+                aArgs.mWidth = (uint32_t)atoi(optarg);
                 break;
             case 5:
-                aArgs.mWarmups = (uint32_t)atoi(optarg);
+                aArgs.mKeys = (uint32_t)atoi(optarg);
                 break;
             case 6:
+                aArgs.mIncrements = (uint32_t)atoi(optarg);
+                break;
+            case 7:
+                aArgs.mWarmups = (uint32_t)atoi(optarg);
+                break;
+            case 8:
                 aArgs.mHotruns = (uint32_t)atoi(optarg);
                 break;
             case 'h':
@@ -486,22 +2098,22 @@ int main(int argc, char **argv)
             }
         }
 
-        return BenchCounter_sweepThreads(&aArgs);
+        return BenchCounter_sweepSketch(&aArgs);
     }
-    else if (strcmp(aSubcommandPtr, "sweep_threshold") == 0)
+    else if (strcmp(aSubcommandPtr, "sweep_processes") == 0)
     {
-        tBenchCounter_sweepThresholdArgs aArgs = {
-            .mNumThreads = 8,
-            .mStartThreshold = 1,
-            .mSteps = 16,
+        tBenchCounter_sweepProcessesArgs aArgs = {
+            .mMinWorkers = 1,
+            .mMaxWorkers = 16,
+            .mStep = 1,
             .mIncrements = 100000,
             .mWarmups = 15,
             .mHotruns = 30};
 
         static struct option aLongOptions[] = {
-            {"num-threads", required_argument, 0, 0},
-            {"start-threshold", required_argument, 0, 1},
-            {"steps", required_argument, 0, 2},
+            {"min-workers", required_argument, 0, 0},
+            {"max-workers", required_argument, 0, 1},
+            {"step", required_argument, 0, 2},
             {"increments", required_argument, 0, 3},
             {"warmups", required_argument, 0, 4},
             {"hotruns", required_argument, 0, 5},
@@ -517,13 +2129,13 @@ int main(int argc, char **argv)
             switch (aC)
             {
             case 0:
-                aArgs.mNumThreads = (uint32_t)atoi(optarg);
+                aArgs.mMinWorkers = (uint32_t)atoi(optarg);
                 break;
             case 1:
-                aArgs.mStartThreshold = (uint32_t)atoi(optarg);
+                aArgs.mMaxWorkers = (uint32_t)atoi(optarg);
                 break;
             case 2:
-                aArgs.mSteps = (uint32_t)atoi(optarg);
+                aArgs.mStep = (uint32_t)atoi(optarg);
                 break;
             case 3:
                 aArgs.mIncrements = (uint32_t)atoi(optarg);
@@ -545,7 +2157,71 @@ int main(int argc, char **argv)
             }
         }
 
-        return BenchCounter_sweepThreshold(&aArgs);
+        return BenchCounter_sweepProcesses(&aArgs);
+    }
+    else if (strcmp(aSubcommandPtr, "sweep_keys") == 0)
+    {
+        tBenchCounter_sweepKeysArgs aArgs = {
+            .mNumThreads = 8,
+            .mThreshold = 64,
+            .mStartKeys = 1024,
+            .mSteps = 8,
+            .mIncrements = 100000,
+            .mWarmups = 15,
+            .mHotruns = 30};
+
+        static struct option aLongOptions[] = {
+            {"num-threads", required_argument, 0, 0},
+            {"threshold", required_argument, 0, 1},
+            {"start-keys", required_argument, 0, 2},
+            {"steps", required_argument, 0, 3},
+            {"increments", required_argument, 0, 4},
+            {"warmups", required_argument, 0, 5},
+            {"hotruns", required_argument, 0, 6},
+            {"help", no_argument, 0, 'h'},
+            {0, 0, 0, 0}};
+
+        int aOptionIndex = 0;
+        int aC;
+        optind = 2; // Skip program name and subcommand
+
+        while ((aC = getopt_long(argc, argv, "h", aLongOptions, &aOptionIndex)) != -1)
+        {
+            switch (aC)
+            {
+            case 0:
+                aArgs.mNumThreads = (uint32_t)atoi(optarg);
+                break;
+            case 1:
+                aArgs.mThreshold = (uint32_t)atoi(optarg);
+                break;
+            case 2:
+                aArgs.mStartKeys = (uint32_t)atoi(optarg);
+                break;
+            case 3:
+                aArgs.mSteps = (uint32_t)atoi(optarg);
+                break;
+            case 4:
+                aArgs.mIncrements = (uint32_t)atoi(optarg);
+                break;
+            case 5:
+                aArgs.mWarmups = (uint32_t)atoi(optarg);
+                break;
+            case 6:
+                aArgs.mHotruns = (uint32_t)atoi(optarg);
+                break;
+            case 'h':
+                BenchCounter_printUsage(argv[0]);
+                return 0;
+            case '?':
+                BenchCounter_printUsage(argv[0]);
+                return 1;
+            default:
+                break;
+            }
+        }
+
+        return BenchCounter_sweepKeys(&aArgs);
     }
     else
     {